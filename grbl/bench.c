@@ -0,0 +1,380 @@
+/*
+  bench.c - cycle-count benchmarks of the firmware hot paths
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  The benchmark firmware runs in place of the main loop and is meant to be executed under a
+  cycle-accurate simulator by 'make bench', although it runs just as well on real hardware. Results
+  are printed over the serial port as 'BENCH,<benchmark>,<case>,<cycles>' lines, which the make
+  target strips down to CSV.
+    Synchronous code is timed with Timer1 free-running at full speed, extended to 32 bits by its
+  overflow interrupt. Timer1 is borrowed from the stepper driver, which is idle during these runs.
+  The stepper ISR itself is timed by the performance counters while executing real motions at step
+  rates chosen to land on each AMASS level.
+  NOTE: The benchmarks overwrite settings in RAM and leave the machine in an arbitrary state. The
+  MCU is halted when finished. Do not flash this build to a machine for use.
+*/
+
+#include "grbl.h"
+
+#ifdef BENCHMARK
+
+#include <avr/sleep.h>
+
+#define BENCH_ISR_STEPS 400 // Steps per axis executed for each stepper ISR case.
+// Stepper ISR cases raise the rate and acceleration limits, so moves run at a constant step rate.
+// Kept finite to keep the planner math in range.
+#define BENCH_RATE_LIMIT 1.0E+7          // (mm/min)
+#define BENCH_ACCELERATION_LIMIT 1.0E+10 // (mm/min^2)
+
+static volatile uint16_t bench_overflow;
+static uint32_t bench_overhead;
+static char bench_line[LINE_BUFFER_SIZE];
+
+
+ISR(TIMER1_OVF_vect) { bench_overflow++; }
+
+
+// Takes Timer1 from the stepper driver and runs it free at full speed.
+static void bench_timer_init()
+{
+  TIMSK1 = 0;
+  TCCR1A = 0;
+  TCCR1B = (1<<CS10); // Normal mode. No prescaling.
+  TIFR1 = (1<<TOV1);
+  TIMSK1 = (1<<TOIE1);
+}
+
+
+// Returns Timer1 to the stepper driver CTC configuration set by stepper_init().
+static void bench_timer_release()
+{
+  TIMSK1 = 0;
+  TCCR1B |= (1<<WGM12);
+}
+
+
+static void bench_start()
+{
+  // Let pending serial output drain, so transmit interrupts don't land in the measurement.
+  while (serial_get_tx_buffer_count()) { }
+  cli();
+  bench_overflow = 0;
+  TCNT1 = 0;
+  TIFR1 = (1<<TOV1);
+  sei();
+}
+
+
+static uint32_t bench_stop()
+{
+  cli();
+  uint16_t ticks = TCNT1;
+  uint16_t overflow = bench_overflow;
+  // Account for an overflow that occurred after interrupts were disabled.
+  if ((TIFR1 & (1<<TOV1)) && (ticks < 0x8000)) { overflow++; }
+  sei();
+  return(((((uint32_t)overflow) << 16) | ticks) - bench_overhead);
+}
+
+
+static void bench_report_begin(const char *name)
+{
+  printPgmString(PSTR("BENCH,"));
+  printPgmString(name);
+  serial_write(',');
+}
+
+
+static void bench_report_end(uint32_t cycles)
+{
+  serial_write(',');
+  print_uint32_base10(cycles);
+  serial_write('\n');
+}
+
+
+static void bench_read_float(const char *s)
+{
+  uint8_t char_counter = 0;
+  float value;
+  strcpy_P(bench_line, s);
+  bench_start();
+  read_float(bench_line, &char_counter, &value);
+  uint32_t cycles = bench_stop();
+  bench_report_begin(PSTR("read_float"));
+  printString(bench_line);
+  bench_report_end(cycles);
+}
+
+
+static void bench_gcode(const char *s)
+{
+  strcpy_P(bench_line, s);
+  plan_reset(); // Keep the planner from filling up and starting a cycle.
+  bench_start();
+  gc_execute_line(bench_line);
+  uint32_t cycles = bench_stop();
+  bench_report_begin(PSTR("gc_execute_line"));
+  printString(bench_line);
+  bench_report_end(cycles);
+}
+
+
+// Reported per generated arc segment. Includes planning each segment and parsing the line once.
+// NOTE: Arcs must fit the planner buffer, or mc_line() would start a cycle to make room.
+static void bench_arc(const char *s)
+{
+  strcpy_P(bench_line, s);
+  plan_reset();
+  bench_start();
+  gc_execute_line(bench_line);
+  uint32_t cycles = bench_stop();
+  uint8_t segments = plan_get_block_buffer_count();
+  if (segments == 0) { return; }
+  bench_report_begin(PSTR("mc_arc_per_segment"));
+  printString(bench_line);
+  bench_report_end(cycles/segments);
+}
+
+
+// Times a single plan_buffer_line(), including planner_recalculate(), with fill blocks queued.
+static void bench_planner(uint8_t fill)
+{
+  float target[N_AXIS];
+  plan_line_data_t pl_data;
+  memset(target, 0, sizeof(target));
+  memset(&pl_data, 0, sizeof(plan_line_data_t));
+  pl_data.feed_rate = 1000.0;
+
+  plan_reset();
+  uint8_t idx;
+  uint32_t cycles = 0;
+  for (idx=0; idx<=fill; idx++) {
+    // Zig-zag, so every junction limits the entry speed and the plan has to be recomputed.
+    target[AXIS_1] += 1.0;
+    target[AXIS_2] = (idx & 1) ? 1.0 : 0.0;
+    if (idx == fill) { bench_start(); }
+    plan_buffer_line(target, &pl_data);
+    if (idx == fill) { cycles = bench_stop(); }
+  }
+  bench_report_begin(PSTR("plan_buffer_line"));
+  print_uint8_base10(fill);
+  printPgmString(PSTR(" blocks"));
+  bench_report_end(cycles);
+}
+
+
+// Fills the empty segment buffer from the start of an accelerating block.
+static void bench_segment_prep()
+{
+  float target[N_AXIS];
+  plan_line_data_t pl_data;
+  memset(target, 0, sizeof(target));
+  memset(&pl_data, 0, sizeof(plan_line_data_t));
+  pl_data.feed_rate = 1000.0;
+  target[AXIS_1] = 100.0;
+
+  plan_reset();
+  st_reset();
+  plan_buffer_line(target, &pl_data);
+  sys.step_control = STEP_CONTROL_NORMAL_OP;
+  bench_start();
+  st_prep_buffer();
+  uint32_t cycles = bench_stop();
+  bench_report_begin(PSTR("st_prep_buffer_per_segment"));
+  printPgmString(PSTR("accelerating"));
+  bench_report_end(cycles/(SEGMENT_BUFFER_SIZE-1));
+}
+
+
+static void bench_status_report()
+{
+  bench_start();
+  report_realtime_status();
+  uint32_t cycles = bench_stop();
+  bench_report_begin(PSTR("report_realtime_status"));
+  printPgmString(PSTR("idle"));
+  bench_report_end(cycles);
+}
+
+
+// Float to decimal conversion used by the reports before the fixed-point path. Kept verbatim as
+// the baseline for the report_position case.
+static void bench_printFloat_legacy(float n, uint8_t decimal_places)
+{
+  if (n < 0) {
+    serial_write('-');
+    n = -n;
+  }
+
+  uint8_t decimals = decimal_places;
+  while (decimals >= 2) { // Quickly convert values expected to be E0 to E-4.
+    n *= 100;
+    decimals -= 2;
+  }
+  if (decimals) { n *= 10; }
+  n += 0.5; // Add rounding factor. Ensures carryover through entire value.
+
+  // Generate digits backwards and store in string.
+  unsigned char buf[13];
+  uint8_t i = 0;
+  uint32_t a = (long)n;
+  while(a > 0) {
+    buf[i++] = (a % 10) + '0'; // Get digit
+    a /= 10;
+  }
+  while (i < decimal_places) {
+     buf[i++] = '0'; // Fill in zeros to decimal point for (n < 1)
+  }
+  if (i == decimal_places) { // Fill in leading zero, if needed.
+    buf[i++] = '0';
+  }
+
+  // Print the generated string.
+  for (; i > 0; i--) {
+    if (i == decimal_places) { serial_write('.'); } // Insert decimal point in right place.
+    serial_write(buf[i-1]);
+  }
+}
+
+
+// Prints the machine position of all axes, as the status report does, either converted from steps
+// through floats as before or with the fixed-point path. The printed position is not a CSV line.
+static void bench_report_position(uint8_t fixed)
+{
+  uint8_t idx;
+  for (idx=0; idx<N_AXIS; idx++) {
+    sys_position[idx] = lround((111.111*idx-123.456)*settings.steps_per_mm[idx]);
+  }
+  bench_start();
+  if (fixed) {
+    for (idx=0; idx<N_AXIS; idx++) {
+      if (idx > 0) { serial_write(','); }
+      printFixed_CoordValue(print_steps_to_coord_units(sys_position[idx], idx));
+    }
+  } else {
+    float position[N_AXIS];
+    system_convert_array_steps_to_mpos(position, sys_position);
+    for (idx=0; idx<N_AXIS; idx++) {
+      if (idx > 0) { serial_write(','); }
+      bench_printFloat_legacy(position[idx], N_DECIMAL_COORDVALUE_MM);
+    }
+  }
+  uint32_t cycles = bench_stop();
+  serial_write('\n');
+  bench_report_begin(PSTR("report_position"));
+  if (fixed) { printPgmString(PSTR("fixed")); }
+  else { printPgmString(PSTR("float")); }
+  bench_report_end(cycles);
+}
+
+
+// Executes a constant-rate move of BENCH_ISR_STEPS steps on the first n_axis axes and reports the
+// stepper ISR time recorded by the performance counters. The step rate selects the AMASS level.
+static void bench_stepper_isr(uint8_t n_axis, uint16_t step_rate, uint8_t amass_level)
+{
+  float target[N_AXIS];
+  plan_line_data_t pl_data;
+  memset(&pl_data, 0, sizeof(plan_line_data_t));
+  system_convert_array_steps_to_mpos(target, sys_position);
+  uint8_t idx;
+  for (idx=0; idx<n_axis; idx++) { target[idx] += BENCH_ISR_STEPS/settings.steps_per_mm[idx]; }
+  pl_data.condition = PL_COND_FLAG_INVERSE_TIME;
+  pl_data.feed_rate = (60.0*step_rate)/BENCH_ISR_STEPS; // Inverse time in 1/min.
+
+  perf_reset();
+  mc_line(target, &pl_data);
+  protocol_buffer_synchronize();
+
+  bench_report_begin(PSTR("stepper_isr_max"));
+  print_uint8_base10(n_axis);
+  printPgmString(PSTR(" axes L"));
+  print_uint8_base10(amass_level);
+  bench_report_end(perf.step_isr_max);
+  bench_report_begin(PSTR("stepper_isr_avg"));
+  print_uint8_base10(n_axis);
+  printPgmString(PSTR(" axes L"));
+  print_uint8_base10(amass_level);
+  bench_report_end(perf.step_isr_avg >> PERF_AVG_SHIFT);
+}
+
+
+void bench_run()
+{
+  uint8_t idx;
+  sys.state = STATE_IDLE;
+
+  bench_timer_init();
+  bench_start();
+  bench_overhead = bench_stop();
+
+  printPgmString(PSTR("BENCH,benchmark,case,cycles\n"));
+
+  bench_read_float(PSTR("1"));
+  bench_read_float(PSTR("-123.456"));
+  bench_read_float(PSTR("0.000123"));
+  bench_read_float(PSTR("12345678.9"));
+
+  bench_gcode(PSTR("G17G21G90G94"));
+  bench_gcode(PSTR("G0X10Y20Z5"));
+  bench_gcode(PSTR("G1X10.5Y-3.25F1200"));
+  bench_gcode(PSTR("G1X-12.3456Y7.8912Z-0.5F800"));
+
+  bench_arc(PSTR("G91G2X1Y1I1J0F500"));
+  bench_arc(PSTR("G91G2X2Y0I1J0F500"));
+  bench_arc(PSTR("G91G3X1Y1Z0.5I0J1F500"));
+
+  bench_planner(0);
+  bench_planner(8);
+  bench_planner(16);
+  bench_planner(24);
+  bench_planner(BLOCK_BUFFER_SIZE-2);
+
+  bench_segment_prep();
+  bench_status_report();
+  bench_report_position(false);
+  bench_report_position(true);
+
+  // Hand Timer1 back to the stepper driver and run real motions from a clean state.
+  bench_timer_release();
+  plan_reset();
+  st_reset();
+  plan_sync_position();
+  gc_sync_position();
+  for (idx=0; idx<N_AXIS; idx++) {
+    settings.max_rate[idx] = BENCH_RATE_LIMIT;
+    settings.acceleration[idx] = BENCH_ACCELERATION_LIMIT;
+  }
+  for (idx=1; idx<=N_AXIS; idx++) {
+    // Level cutoffs are at 8kHz, 4kHz and 2kHz. See AMASS_LEVELx in stepper.c.
+    bench_stepper_isr(idx, 10000, 0);
+    bench_stepper_isr(idx, 6000, 1);
+    bench_stepper_isr(idx, 3000, 2);
+    bench_stepper_isr(idx, 1000, 3);
+  }
+
+  // Halt. A simulator quits when the MCU sleeps with interrupts disabled.
+  while (serial_get_tx_buffer_count()) { }
+  delay_ms(10);
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  sleep_enable();
+  cli();
+  sleep_cpu();
+}
+
+#endif
@@ -0,0 +1,29 @@
+/*
+  bench.h - cycle-count benchmarks of the firmware hot paths
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef bench_h
+#define bench_h
+
+#include "grbl.h"
+
+
+// Runs all benchmarks in place of the main loop, prints the results as CSV over the serial port
+// and halts the MCU. Only built by 'make bench', which defines BENCHMARK.
+void bench_run();
+
+#endif
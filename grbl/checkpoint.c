@@ -0,0 +1,130 @@
+/*
+  checkpoint.c - job checkpoint for resuming a job after an alarm or reset
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  A job is resumed by replaying it, rather than by restoring a snapshot of the g-code parser state.
+  The parser runs up to a full planner buffer ahead of the motion, so its state at the time of an
+  alarm may already include modal changes from lines that never executed. Instead, the host streams
+  the job again from the start after '$K=<line>'. Lines up to the checkpoint are parsed in check
+  mode, which rebuilds the modal state, offsets and position exactly without moving. The first line
+  numbered past the checkpoint restores the spindle and coolant, moves to where that line starts,
+  and the job carries on from there.
+*/
+
+#include "grbl.h"
+
+#ifdef ENABLE_JOB_CHECKPOINT
+
+volatile checkpoint_t checkpoint;
+
+// Line number last stored in EEPROM, and whether an interrupted job still needs storing.
+static int32_t checkpoint_stored_line_number;
+static uint8_t checkpoint_store_pending;
+
+
+// Writes the line number and position to EEPROM. Only called from the main program, with the
+// stepper ISR idle, since an EEPROM write takes several milliseconds per changed byte.
+static void checkpoint_store()
+{
+  int32_t checkpoint_data[N_AXIS+1];
+  checkpoint_data[0] = checkpoint.line_number;
+  memcpy(&checkpoint_data[1], (int32_t *)checkpoint.position, sizeof(checkpoint.position));
+  settings_write_checkpoint(checkpoint_data);
+  checkpoint_stored_line_number = checkpoint.line_number;
+  checkpoint_store_pending = false;
+}
+
+
+void checkpoint_init()
+{
+  int32_t checkpoint_data[N_AXIS+1];
+  settings_read_checkpoint(checkpoint_data); // Cleared upon a checksum failure.
+  checkpoint.line_number = checkpoint_data[0];
+  memcpy((int32_t *)checkpoint.position, &checkpoint_data[1], sizeof(checkpoint.position));
+  checkpoint_stored_line_number = checkpoint.line_number;
+}
+
+
+void checkpoint_reset()
+{
+  checkpoint.replay_line_number = 0;
+  if (checkpoint_store_pending) { checkpoint_store(); }
+}
+
+
+void checkpoint_interrupt()
+{
+  // NOTE: Called with the steppers already stopped. Exact unless steps were lost in the abort.
+  // mc_reset() may run from an interrupt, so the EEPROM write is left to checkpoint_reset().
+  memcpy((int32_t *)checkpoint.position, sys_position, sizeof(sys_position));
+  checkpoint_store_pending = true;
+}
+
+
+void checkpoint_cycle_complete()
+{
+  // NOTE: The stepper ISR is idle at the end of a cycle, so the checkpoint is safe to write here.
+  // Stored only when a new line completed, so idle cycle ends, like jogs, do not wear the EEPROM.
+  int32_t line_number = st_get_exec_line_number();
+  if (line_number) { checkpoint.line_number = line_number; }
+  if (checkpoint.line_number != checkpoint_stored_line_number) { checkpoint_store(); }
+}
+
+
+uint8_t checkpoint_replay(int32_t line_number)
+{
+  if (sys.state != STATE_IDLE) { return(STATUS_IDLE_ERROR); } // Requires no alarm mode.
+  checkpoint.replay_line_number = line_number;
+  sys.state = STATE_CHECK_MODE;
+  report_feedback_message(MESSAGE_CHECKPOINT_REPLAY);
+  return(STATUS_OK);
+}
+
+
+void checkpoint_resume()
+{
+  checkpoint.replay_line_number = 0;
+  sys.state = STATE_IDLE;
+  report_feedback_message(MESSAGE_CHECKPOINT_RESUME);
+
+  // Restore the spindle and coolant states left by the replayed lines.
+  plan_line_data_t plan_data;
+  plan_line_data_t *pl_data = &plan_data;
+  memset(pl_data,0,sizeof(plan_line_data_t));
+  pl_data->condition = (PL_COND_FLAG_RAPID_MOTION | gc_state.modal.spindle | gc_state.modal.coolant);
+  if (bit_isfalse(settings.flags,BITFLAG_LASER_MODE)) { pl_data->spindle_speed = gc_state.spindle_speed; }
+  spindle_sync(gc_state.modal.spindle, pl_data->spindle_speed);
+  coolant_sync(gc_state.modal.coolant);
+
+  // Approach the start of the line with rapids. Raise the Z axes first, if the start is above them.
+  // Then move the other axes, and lower the Z axes onto the start last.
+  float target[N_AXIS];
+  uint8_t idx;
+  system_convert_array_steps_to_mpos(target,sys_position);
+  for (idx=0; idx<N_AXIS; idx++) {
+    if (bit_istrue(axis_Z_mask,bit(idx)) && (gc_state.position[idx] > target[idx])) { target[idx] = gc_state.position[idx]; }
+  }
+  mc_line(target, pl_data);
+  for (idx=0; idx<N_AXIS; idx++) {
+    if (bit_isfalse(axis_Z_mask,bit(idx))) { target[idx] = gc_state.position[idx]; }
+  }
+  mc_line(target, pl_data);
+  mc_line(gc_state.position, pl_data);
+}
+
+#endif
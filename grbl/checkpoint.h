@@ -0,0 +1,55 @@
+/*
+  checkpoint.h - job checkpoint for resuming a job after an alarm or reset
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef checkpoint_h
+#define checkpoint_h
+
+#include "grbl.h"
+
+
+// NOTE: Not cleared on a soft-reset, like sys_position, so the checkpoint survives the reset that
+// interrupted the job. The line number and position are also stored in EEPROM at the end of each
+// cycle and after an interrupted job, so the checkpoint survives a power loss too.
+typedef struct {
+  int32_t line_number;      // Last numbered line executed to completion. Set by the stepper ISR.
+  int32_t position[N_AXIS]; // Machine position in steps where the last job was interrupted.
+  int32_t replay_line_number; // Lines up to this number are only parsed while replaying a job.
+} checkpoint_t;
+extern volatile checkpoint_t checkpoint;
+
+
+// Loads the checkpoint stored in EEPROM. Called at power-up.
+void checkpoint_init();
+
+// Ends a job replay, and stores the checkpoint of an interrupted job. Called upon a system abort.
+void checkpoint_reset();
+
+// Records the machine position where a running job was stopped. Called by mc_reset().
+void checkpoint_interrupt();
+
+// Records the last block executed as complete, when a cycle ends with the planner buffer empty.
+void checkpoint_cycle_complete();
+
+// Starts replaying a job in check mode. The streamed lines rebuild the g-code parser state, until
+// the first line numbered above line_number resumes the job.
+uint8_t checkpoint_replay(int32_t line_number);
+
+// Restores the spindle and coolant, and moves to the start of the line the replay ends at.
+void checkpoint_resume();
+
+#endif
@@ -45,6 +45,17 @@
 #define CPU_MAP_2560_RAMBO_BOARD
 
 // Serial baud rate
+// NOTE: At 16MHz, only 250000, 500000, 1000000 and 2000000 are generated exactly. The classic
+// 115200 and 230400 rates carry a 2-4% clock error. High baud rates require a USB-to-serial
+// chip that supports them and should be paired with serial flow control (see ENABLE_XONXOFF
+// and ENABLE_RTS_FLOW_CONTROL), since the main program can not parse g-code at 1Mbaud.
+// 1000000 is the highest supported rate. A byte lasts only 80 cycles at 2Mbaud, less than the
+// receive interrupt takes, so back-to-back bytes would overrun the UART. By the estimated
+// interrupt timings of 'make serial_soak', 1000000 holds with step rates up to about 20kHz and
+// 500000 up to 30kHz. Check the timing of your build with it before going above 500000.
+// #define BAUD_RATE 1000000
+// #define BAUD_RATE 500000
+// #define BAUD_RATE 250000
 // #define BAUD_RATE 230400
 #define BAUD_RATE 115200
 
@@ -83,6 +94,31 @@
   #error "N_AXIS must be <= 6. N_AXIS > 6 is not implemented."
 #endif
 
+// Drives the motor of a cloned axis as a second motor of the axis it is named after, like the two
+// motors of a gantry. Axes 4 and up that share their name with one of the first three axes are
+// ganged. A ganged motor steps with its master's Bresenham counter, takes its master's step count
+// and direction, and is left out of the planner kinematics, so it no longer distorts the line
+// length and the feed rate. During the homing cycle, the motors run on their own again, so each
+// one homes to its own limit switch and the gantry is squared with the endstop adjustments $15x.
+// NOTE: Set the steps per mm of both motors alike. The ganged motor always follows its master.
+// Enabling this changes how existing cloned-axis setups run, such as the default RAMBo and RAMPS
+// maps with axes 4 and 5 named X and Y. The ganged axes' own max rate $11x and acceleration $12x
+// settings are ignored, and their position comes from the master instead of the g-code target.
+// When disabled, cloned axes are planned and stepped as separate axes.
+// #define GANGED_AXES // Default disabled. Uncomment to enable.
+
+// Drives one axis from its own step generator on a spare 16-bit timer, independent of the
+// coordinated motion of the other axes. Meant for rotary indexers and conveyors that index or load
+// parts while the job keeps cutting. The axis is taken out of g-code: its axis words are rejected and
+// the planner never moves it. Instead, '$E=<position>' queues a move to a machine position, at the
+// rate of an optional F word or else the axis maximum rate, and returns right away. '$E' alone waits
+// until the indexer has stopped. Must be AXIS_4, AXIS_5 or AXIS_6 with a letter of its own, and the
+// cpu map must define the indexer timer. The axis can't be homed.
+// NOTE: '$E' runs when the line is read, ahead of any buffered g-code motion. Feed holds and the
+// safety door do not stop the indexer. A reset stops it at once and, if it was moving, raises an
+// alarm, since steps may have been lost.
+// #define INDEXER_AXIS AXIS_5 // Default disabled. Uncomment to enable.
+
 // Define realtime command special characters. These characters are 'picked-off' directly from the
 // serial read data stream and are not passed to the grbl line execution parser. Select characters
 // that do not and must not exist in the streamed g-code program. ASCII control characters may be
@@ -236,6 +272,19 @@
 #define SAFETY_DOOR_SPINDLE_DELAY 4.0 // Float (seconds)
 #define SAFETY_DOOR_COOLANT_DELAY 1.0 // Float (seconds)
 
+// Enables a spindle tachometer on the input capture pin of the cpu map. Only the Ramps 1.4 map has
+// one, on Aux-3 D49. Grbl reports the measured spindle speed as a third value of the '|FS:' status
+// report field. M3/M4 and spindle speed changes, the safety door restore and the spindle stop
+// override restore then wait only until the spindle reaches SPINDLE_AT_SPEED_PERCENT of the
+// programmed speed, rather than SAFETY_DOOR_SPINDLE_DELAY or a G4 dwell in the program. If the
+// spindle doesn't get there within SPINDLE_AT_SPEED_TIMEOUT, Grbl stops it and issues an alarm.
+// NOTE: Laser mode doesn't wait. The tachometer shares its timer with INDEXER_AXIS. A spindle turning
+// slower than one tachometer pulse per second reads as stopped.
+// #define SPINDLE_AT_SPEED // Default disabled. Uncomment to enable.
+#define SPINDLE_TACH_PULSES_PER_REV 1 // Integer (1-255). Tachometer pulses per spindle revolution.
+#define SPINDLE_AT_SPEED_PERCENT 95 // Integer (1-100). Share of the programmed speed to proceed at.
+#define SPINDLE_AT_SPEED_TIMEOUT 10.0 // Float (seconds). Spin-up time before the alarm.
+
 // Enable CoreXY kinematics. Use ONLY with CoreXY machines.
 // IMPORTANT: If homing is enabled, you must reconfigure the homing cycle #defines above to
 // #define HOMING_CYCLE_0 (1<<AXIS_1) and #define HOMING_CYCLE_1 (1<<AXIS_2)
@@ -294,12 +343,36 @@
 // not throw an alarm message.
 #define CHECK_LIMITS_AT_INIT
 
+// Enables a job checkpoint for resuming a long job after an alarm or a reset. Grbl tracks the last
+// numbered line (N-word) executed to completion and keeps it, along with the machine position where
+// the job stopped, through soft-resets. Both are also stored in EEPROM at the end of each cycle and
+// after an interrupted job, so they survive a power loss. '$K' reports both. After re-homing or
+// unlocking, '$K=<line>' enters a replay mode and the host streams the job again from the start.
+// Lines up to the checkpoint are only parsed, like in check mode, to rebuild the modal state, offsets
+// and position. The first line numbered past it turns the spindle and coolant back on, rapids to
+// where that line starts, Z axes raised first and lowered last, and resumes. Requires the host to
+// number its lines.
+// NOTE: The reported position is exact only if the job was stopped by a feed hold before the reset.
+// NOTE: The EEPROM is not written while a cycle runs. A power loss mid-cycle leaves the checkpoint
+// at the end of the previous cycle, or of the previous interrupted job.
+// #define ENABLE_JOB_CHECKPOINT // Default disabled. Uncomment to enable.
+
 // ---------------------------------------------------------------------------------------
 // ADVANCED CONFIGURATION OPTIONS:
 
 // Enables code for debugging purposes. Not for general use and always in constant flux.
 //#define DEBUG // Uncomment to enable. Default disabled.
 
+// Enables lightweight runtime performance counters and the '$P' command to report them, '$PR' to
+// clear them. Tracks the worst-case and average stepper ISR time, segment buffer underruns, planner
+// buffer empty events, main loop iteration time, planner recalculation pass lengths, blocks slowed
+// down by MINIMUM_BLOCK_TIME, and serial characters dropped on a full RX buffer. Useful to tell
+// whether a slow job is planner-starved, serial-starved or ISR-bound. Also paints free RAM at
+// power-up to report the stack high-water mark, which shows how far buffer sizes can be raised. Adds
+// a few cycles to the stepper ISR and uses Timer3 as a free-running clock.
+// NOTE: Counters persist through soft-resets and are only cleared by '$PR' or a power-cycle.
+// #define ENABLE_PERFORMANCE_COUNTERS // Default disabled. Uncomment to enable.
+
 // Configure rapid, feed, and spindle override settings. These values define the max and min
 // allowable override values and the coarse and fine increments per command received. Please
 // note the allowable values in the descriptions following each define.
@@ -368,6 +441,15 @@
 // step smoothing. See stepper.c for more details on the AMASS system works.
 #define ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING  // Default enabled. Comment to disable.
 
+// Ramps the step rate linearly within each step segment, instead of holding it constant for the
+// segment time set by ACCELERATION_TICKS_PER_SECOND. Without it, acceleration is a staircase of
+// rate changes at the segment rate, which can excite resonances at the step boundaries. Each
+// segment carries its starting step period and a fixed-point change per stepper ISR tick, so the
+// ISR only adds and writes the timer. The periods average the constant segment rate, so motion
+// timing and step counts are unchanged. Requires AMASS, whose levels are applied per segment before
+// the ramp is computed.
+// #define STEP_RATE_RAMPS // Default disabled. Uncomment to enable.
+
 // Sets the maximum step rate allowed to be written as a Grbl setting. This option enables an error
 // check in the settings module to prevent settings values that will exceed this limitation. The maximum
 // step rate is strictly limited by the CPU speed and will change if something other than an AVR running
@@ -438,6 +520,14 @@
 // machines, perhaps to 0.1mm/min, but your success may vary based on multiple factors.
 #define MINIMUM_FEED_RATE 1.0 // (mm/min)
 
+// Sets the minimum time the planner lets a block execute in. Very short blocks streamed at a high feed
+// rate can execute faster than Grbl parses, plans and prepares the next one. The step segment buffer
+// then runs dry and the machine stutters to a stop and start between blocks. This caps the nominal
+// speed of each block, so it takes no less than this time and the stream slows down smoothly instead.
+// Set it somewhat above the average main loop time reported by '$P' while running a demanding job.
+// The '$P' report also counts the blocks slowed down by this limit. Homing and parking are exempt.
+// #define MINIMUM_BLOCK_TIME 2.0 // (milliseconds) Default disabled. Uncomment to enable.
+
 // Number of arc generation iterations by small angle approximation before exact arc trajectory
 // correction with expensive sin() and cos() calcualtions. This parameter maybe decreased if there
 // are issues with the accuracy of the arc generations, or increased if arc execution is getting
@@ -479,6 +569,14 @@
 // up with planning new incoming motions as they are executed.
 // #define BLOCK_BUFFER_SIZE 36  // Uncomment to override default in planner.h.
 
+// After a feed or rapid override change, the planner buffer is replanned for the new speeds a few
+// blocks at a time, interleaved with the step segment generator, instead of all at once. The blocks
+// about to be executed are replanned first. This sets the number of blocks per slice, which bounds
+// the time the main loop spends on an override. Smaller slices respond more smoothly on a full
+// buffer of short blocks, but more often replan blocks of the previous slice again when it has to
+// decelerate into the next one. Must be at least 2.
+// #define PLANNER_OVERRIDE_SLICE_BLOCKS 6 // Uncomment to override default in planner.h.
+
 // Governs the size of the intermediary step segment buffer between the step execution algorithm
 // and the planner blocks. Each segment is set of steps executed at a constant velocity over a
 // fixed time defined by ACCELERATION_TICKS_PER_SECOND. They are computed such that the planner
@@ -487,6 +585,25 @@
 // before having to come back and refill this buffer, currently at ~50msec of step moves.
 // #define SEGMENT_BUFFER_SIZE 10 // Uncomment to override default in stepper.h.
 
+// Stretches step segments on cruise phases up to this many times the segment time set by
+// ACCELERATION_TICKS_PER_SECOND. Cruise segments are all alike, so fewer and longer ones trace the
+// same motion with less segment preparation in the main loop, leaving more time to parse and plan.
+// Acceleration and deceleration ramps keep the short segments. The segment buffer is then filled
+// up to the time it holds with short segments, rather than up to its size, so feed holds and
+// overrides take effect as quickly as before. Must be an integer from 2 to 6.
+// #define SEGMENT_CRUISE_TIME_SCALE 4 // Default disabled. Uncomment to enable.
+
+// Keeps the step counts of the segment generator in integers rather than floats. The steps remaining
+// in a block are always whole, so rounding them up and subtracting them for each segment reduces to
+// integer operations, and the soft-float ceil() calls are replaced by a truncation and a compare.
+// NOTE: This is not a fixed-point segment generator. Per segment, it saves two ceil() calls, a float
+// subtraction and a float to integer conversion. The velocity profile, the distance remaining and
+// the step rate, which make up most of the per-segment time, are still integrated in floats. The
+// generated segments are therefore identical to those of the float path for blocks of up to 2^24
+// steps, beyond which the float path starts rounding step counts. Compare the segments with 'make
+// segment_diff', and the cycles with the st_prep_buffer_per_segment case of 'make bench'.
+// #define SEGMENT_PREP_INTEGER_STEPS // Default disabled. Uncomment to enable.
+
 // Line buffer size from the serial input stream to be executed. Also, governs the size of
 // each of the startup blocks, as they are each stored as a string of this size. Make sure
 // to account for the available EEPROM at the defined memory address in settings.h and for
@@ -497,6 +614,16 @@
 // we know how much extra memory space we can re-invest into this.
 // #define LINE_BUFFER_SIZE 256  // Uncomment to override default in protocol.h
 
+// Moves the initial line filtering (removing spaces and comments and capitalizing letters) from
+// the main program into the serial receive interrupt, which also terminates each line in place.
+// Complete lines are then executed directly out of the serial receive buffer, instead of being
+// copied character by character into the line buffer by the main program. Only lines wrapping
+// around the end of the receive buffer and '$' system commands are still copied. As a side
+// effect, comments and whitespace no longer take up room in the receive buffer.
+// NOTE: Character-counting streamers must account for lines over RX_BUFFER_SIZE-2 characters
+// being reported as an overflow, after filtering, when this is enabled.
+// #define ENABLE_RX_LINE_ASSEMBLY // Default disabled. Uncomment to enable.
+
 // Serial send and receive buffer size. The receive buffer is often used as another streaming
 // buffer to store incoming blocks to be processed by Grbl when its ready. Most streaming
 // interfaces will character count and track each block send to each block response. So,
@@ -523,6 +650,23 @@
 // case, please report any successes to grbl administrators!
 // #define ENABLE_XONXOFF // Default disabled. Uncomment to enable.
 
+// Enables hardware RTS flow control for serial communications. Grbl drives the RTS output pin
+// (wired to the host adapter's CTS input) active low while the serial receive buffer has room
+// and de-asserts it once the buffer fills past the high watermark below. It is re-asserted when
+// the main program drains the buffer below the low watermark. Unlike XON/XOFF, there is no
+// in-band latency, so dumb streamers can send a whole file at full baud without any losses.
+// NOTE: Requires a USB-to-serial adapter with its CTS line wired to the pin defined in cpu_map.h.
+// Realtime command characters are always picked off by the RX interrupt and never count toward
+// the watermarks, so they may be sent at any time, even when the host has been told to stop.
+// #define ENABLE_RTS_FLOW_CONTROL // Default disabled. Uncomment to enable.
+
+// Serial receive buffer watermarks used by the XON/XOFF and RTS flow control options above. The
+// stop signal is issued when the number of queued bytes reaches the high watermark, and the
+// resume signal when it falls below the low watermark. The headroom above the high watermark must
+// absorb the bytes that are still in flight in the host and USB-to-serial chip buffers.
+// #define RX_BUFFER_FLOW_HIGH (RX_BUFFER_SIZE-64) // Uncomment to override defaults in serial.h
+// #define RX_BUFFER_FLOW_LOW (RX_BUFFER_SIZE-128)
+
 // A simple software debouncing feature for hard limit switches. When enabled, the interrupt
 // monitoring the hard limit switch pins will enable the Arduino's watchdog timer to re-check
 // the limit pin state after a delay of about 32msec. This can help with CNC machines with
@@ -659,9 +803,21 @@
 // to ensure the laser doesn't inadvertently remain powered while at a stop and cause a fire.
 #define DISABLE_LASER_DURING_HOLD // Default enabled. Comment to disable.
 
+// Enables raster engraving in laser mode. A G1 block may end with a 'D' word of hex digit pairs, one
+// pair per pixel, e.g. 'G1X25.4S1000D00407FFF'. The pixels are spaced evenly along the line, and the
+// stepper ISR sets the laser power of each pixel as the tool reaches it, scaling the block power by
+// 0-255/255. A whole scanline then streams and plans as one block, rather than one block per change
+// of power. The pixels are buffered apart from the planner, see RASTER_BUFFER_SIZE in raster.h.
+// NOTE: Pixels keep their power while the tool accelerates, unless M4 scales it with the speed. Add
+// overscan to the scanlines, so the pixels are engraved at the feed rate.
+// #define LASER_RASTER // Default disabled. Uncomment to enable.
+
 // Enables a piecewise linear model of the spindle PWM/speed output. Requires a solution by the
 // 'fit_nonlinear_spindle.py' script in the /doc/script folder of the repo. See file comments
 // on how to gather spindle data and run the script to generate a solution.
+// NOTE: Like the default linear model, the model only fills the RPM to PWM lookup table, when the
+// $30/$31 settings change. Raise SPINDLE_PWM_TABLE_SIZE in spindle_control.h, if the table cuts
+// the corners between the lines too much.
 // #define ENABLE_PIECEWISE_LINEAR_SPINDLE  // Default disabled. Uncomment to enable.
 
 // N_PIECES, RPM_MAX, RPM_MIN, RPM_POINTxx, and RPM_LINE_XX constants are all set and given by
@@ -683,6 +839,28 @@
 #define RPM_LINE_A4  1.203413e-01  // Used N_PIECES = 4. A and B constants of line 4.
 #define RPM_LINE_B4  1.151360e+03
 
+// Enables a measured spindle PWM/speed curve in place of a line fit. List the actual spindle rpm,
+// measured with a tachometer or similar means, at evenly spaced PWM values from SPINDLE_PWM_MIN_VALUE
+// to SPINDLE_PWM_MAX_VALUE, in the order of increasing PWM. Any number of points from two up is
+// accepted, and the curve may take any monotonic shape. Grbl interpolates between the points to fill
+// the RPM to PWM lookup table. $30 and $31 are limited to the first and last measured rpm.
+// NOTE: The rpm must increase from point to point. Trim any flat or falling ends from the data, as
+// for the 'fit_nonlinear_spindle.py' script, and move SPINDLE_PWM_MIN/MAX_VALUE to where it ends.
+// #define SPINDLE_PWM_CURVE 202.5, 1950.0, 3710.0, 5390.0, 6950.0, 8230.0, 9440.0, 10460.0, 11220.0 // Default disabled. Uncomment to enable.
+
+// Enables motor current profiles on boards with digipot driver current control, like the RAMBo.
+// The $14x axis currents become the run currents of a cruise. The motors drop to an idle current
+// when at rest or holding, and get a boost while accelerating or decelerating, which permits a
+// higher acceleration without the motors running hot all the time. The phase follows the segments
+// in the step buffer, so the boost starts ahead of a ramp and ends after it. All motors switch
+// phase together. Each list below takes one percentage of the run current per axis, N_AXIS in all.
+// NOTE: The digipots are written from the SPI interrupt, so a phase change never stalls the main loop.
+// #define MOTOR_CURRENT_PROFILES // Default disabled. Uncomment to enable.
+#ifdef MOTOR_CURRENT_PROFILES
+  #define MOTOR_CURRENT_IDLE_PERCENT { 50, 50, 100, 50, 50 } // Integer (0-255). Z holds at full current.
+  #define MOTOR_CURRENT_BOOST_PERCENT { 125, 125, 125, 125, 125 } // Integer (0-255). Limited to digipot max.
+#endif
+
 
 /* ---------------------------------------------------------------------------------------
    OEM Single File Configuration Option
@@ -347,6 +347,11 @@
   #define PROBE_BIT       7  // MEGA2560 Analog Pin 15
   #define PROBE_MASK      (1<<PROBE_BIT)
 
+  // Define serial RTS flow control output pin. Wire to the CTS input of the host serial adapter.
+  #define SERIAL_RTS_DDR    DDRH
+  #define SERIAL_RTS_PORT   PORTH
+  #define SERIAL_RTS_BIT    3 // MEGA2560 Digital Pin 6 - Ramps 1.4 Servo 2 Signal pin (D6)
+
   // Advanced Configuration Below You should not need to touch these variables
   // Set Timer up to use TIMER5B which is attached to Digital Pin 44 - Ramps 1.4 AUX-2
   #define SPINDLE_PWM_MAX_VALUE     1024.0 // Translates to about 1.9 kHz PWM frequency at 1/8 prescaler
@@ -373,6 +378,38 @@
   #define SPINDLE_PWM_PORT  PORTL
   #define SPINDLE_PWM_BIT   5 // MEGA2560 Digital Pin 44
 
+  // Define the spare timer of the independent indexer axis. See INDEXER_AXIS in config.h.
+  #define INDEXER_TCCRA_REGISTER    TCCR4A
+  #define INDEXER_TCCRB_REGISTER    TCCR4B
+  #define INDEXER_TCNT_REGISTER     TCNT4
+  #define INDEXER_OCR_REGISTER      OCR4A
+  #define INDEXER_TIMSK_REGISTER    TIMSK4
+  #define INDEXER_TIFR_REGISTER     TIFR4
+  #define INDEXER_OCIE_BIT          OCIE4A
+  #define INDEXER_OCF_BIT           OCF4A
+  #define INDEXER_TCCRB_INIT_MASK   ((1<<WGM42) | (1<<CS41)) // CTC mode, 1/8 prescaler
+  #define INDEXER_TICKS_PER_SECOND  (F_CPU/8)
+  #define INDEXER_COMPA_vect        TIMER4_COMPA_vect
+
+  // Define the spindle tachometer input. Uses the input capture unit of the indexer axis timer, so
+  // only one of them may be enabled. See SPINDLE_AT_SPEED in config.h.
+  #define SPINDLE_TACH_DDR              DDRL
+  #define SPINDLE_TACH_PORT             PORTL
+  #define SPINDLE_TACH_BIT              0 // MEGA2560 Digital Pin 49 (ICP4) - Ramps 1.4 Aux-3
+  #define SPINDLE_TACH_TCCRA_REGISTER   TCCR4A
+  #define SPINDLE_TACH_TCCRB_REGISTER   TCCR4B
+  #define SPINDLE_TACH_ICR_REGISTER     ICR4
+  #define SPINDLE_TACH_TIMSK_REGISTER   TIMSK4
+  #define SPINDLE_TACH_TIFR_REGISTER    TIFR4
+  #define SPINDLE_TACH_ICIE_BIT         ICIE4
+  #define SPINDLE_TACH_TOIE_BIT         TOIE4
+  #define SPINDLE_TACH_ICF_BIT          ICF4
+  #define SPINDLE_TACH_TOV_BIT          TOV4
+  #define SPINDLE_TACH_TCCRB_INIT_MASK  ((1<<ICNC4) | (1<<ICES4) | (1<<CS41)) // Normal mode, noise canceler, rising edge, 1/8 prescaler
+  #define SPINDLE_TACH_TICKS_PER_SECOND (F_CPU/8)
+  #define SPINDLE_TACH_CAPT_vect        TIMER4_CAPT_vect
+  #define SPINDLE_TACH_OVF_vect         TIMER4_OVF_vect
+
 #endif
 
 #ifdef CPU_MAP_2560_RAMBO_BOARD // (Arduino Mega 2560) with Ultimachine RAMBo 1.4 Board
@@ -560,6 +597,11 @@
   #define PROBE_BIT       4 // Zmin - PB4
   #define PROBE_MASK      (1<<PROBE_BIT)
 
+  // Define serial RTS flow control output pin. Wire to the CTS input of the host serial adapter.
+  #define SERIAL_RTS_DDR    DDRF
+  #define SERIAL_RTS_PORT   PORTF
+  #define SERIAL_RTS_BIT    3 // Analog A3 / PF3
+
   // Advanced Configuration Below You should not need to touch these variables
   // Set Timer up to use TIMER5B which is attached to Digital Pin 44 - Ramps 1.4 AUX-2
   #define SPINDLE_PWM_MAX_VALUE     1024.0 // Translates to about 1.9 kHz PWM frequency at 1/8 prescaler
@@ -585,6 +627,19 @@
   #define SPINDLE_PWM_PORT  PORTL
   #define SPINDLE_PWM_BIT   4 // D45 / PL4
 
+  // Define the spare timer of the independent indexer axis. See INDEXER_AXIS in config.h.
+  #define INDEXER_TCCRA_REGISTER    TCCR4A
+  #define INDEXER_TCCRB_REGISTER    TCCR4B
+  #define INDEXER_TCNT_REGISTER     TCNT4
+  #define INDEXER_OCR_REGISTER      OCR4A
+  #define INDEXER_TIMSK_REGISTER    TIMSK4
+  #define INDEXER_TIFR_REGISTER     TIFR4
+  #define INDEXER_OCIE_BIT          OCIE4A
+  #define INDEXER_OCF_BIT           OCF4A
+  #define INDEXER_TCCRB_INIT_MASK   ((1<<WGM42) | (1<<CS41)) // CTC mode, 1/8 prescaler
+  #define INDEXER_TICKS_PER_SECOND  (F_CPU/8)
+  #define INDEXER_COMPA_vect        TIMER4_COMPA_vect
+
   // Digipots pins
   #define HAS_DIGIPOTS 1
   #define DIGIPOTSS_DDR DDRD
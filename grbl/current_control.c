@@ -25,9 +25,28 @@
 
 #ifdef HAS_DIGIPOTS
 
+#ifdef MOTOR_CURRENT_PROFILES
+// Digipot writes are queued for the SPI transfer complete interrupt, so the main loop never
+// waits on the bus. Only the latest value of each motor is kept, so the queue can't overflow.
+#define SPI_IDLE 0
+#define SPI_SEND_CHANNEL 1
+#define SPI_SEND_VALUE 2
+
+static const uint8_t digipot_ch[] = DIGIPOT_CHANNELS;
+static volatile uint8_t spi_pending_mask; // Motors with a value waiting to be sent.
+static volatile uint8_t spi_pending_value[N_AXIS];
+static volatile uint8_t spi_value; // Value of the write in progress.
+static volatile uint8_t spi_state;
+
+static uint8_t current_profile[CURRENT_N_PHASES][N_AXIS]; // Digipot values of each phase.
+static uint8_t current_phase; // Phase last sent to the digipots.
+#endif
+
 void current_init()
 {
+#ifndef MOTOR_CURRENT_PROFILES
     static const uint8_t digipot_motor_current[] = DIGIPOT_MOTOR_CURRENT;
+#endif
     // Set the SS pin to high
     SPI_DDR |= (1<<SS_BIT);
 
@@ -36,6 +55,13 @@ void current_init()
     // Set MOSI, SCK as Output
     SPI_DDR |= (1<<MOSI_BIT)|(1<<SCK_BIT);
 
+#ifdef MOTOR_CURRENT_PROFILES
+    // Initialize SPI as master with the transfer complete interrupt, and start at the idle current.
+    spi_pending_mask = 0;
+    spi_state = SPI_IDLE;
+    SPCR = (1<<SPIE)|(1<<SPE)|(1<<MSTR);
+    current_load_profiles();
+#else
     // Initialize SPI as master
     SPCR = (1<<SPE)|(1<<MSTR);
 
@@ -43,8 +69,91 @@ void current_init()
     for (i = 0; i < N_AXIS; i++) {
         set_current(i, digipot_motor_current[i]);
     }
+#endif
+}
+
+#ifdef MOTOR_CURRENT_PROFILES
+
+// Starts the write of the next pending motor, if any. Called with interrupts disabled.
+static void spi_start_next()
+{
+    uint8_t motor = 0;
+    if (!spi_pending_mask) {
+        spi_state = SPI_IDLE;
+        return;
+    }
+    while (!(spi_pending_mask & (1<<motor))) { motor++; }
+    spi_pending_mask &= ~(1<<motor);
+    spi_value = spi_pending_value[motor];
+    spi_state = SPI_SEND_CHANNEL;
+    // Take the SS pin low to select the chip and send the address
+    DIGIPOTSS_PORT &= ~(1<<DIGIPOTSS_BIT);
+    SPDR = digipot_ch[motor];
+}
+
+ISR(SPI_STC_vect)
+{
+    if (spi_state == SPI_SEND_CHANNEL) {
+        spi_state = SPI_SEND_VALUE;
+        SPDR = spi_value;
+    } else {
+        // Take the SS pin high to de-select the chip, then go on with the queue
+        DIGIPOTSS_PORT |= (1<<DIGIPOTSS_BIT);
+        spi_start_next();
+    }
+}
+
+// Queues the write of a motor current. Returns at once. The write goes out from the SPI interrupt.
+void set_current(uint8_t motor, uint8_t value)
+{
+    uint8_t sreg = SREG;
+    cli();
+    spi_pending_value[motor] = value;
+    spi_pending_mask |= (1<<motor);
+    if (spi_state == SPI_IDLE) { spi_start_next(); }
+    SREG = sreg;
+}
+
+// Scales a $14x run current by a profile percentage, within the digipot range.
+static uint8_t current_scale(float run_current, uint8_t percent)
+{
+    float value = run_current*(0.01*percent);
+    if (value > 255.0) { return(255); }
+    return(value);
+}
+
+void current_load_profiles()
+{
+    static const uint8_t idle_percent[] = MOTOR_CURRENT_IDLE_PERCENT;
+    static const uint8_t boost_percent[] = MOTOR_CURRENT_BOOST_PERCENT;
+    uint8_t i;
+    for (i = 0; i < N_AXIS; i++) {
+        current_profile[CURRENT_PHASE_IDLE][i] = current_scale(settings.current[i], idle_percent[i]);
+        current_profile[CURRENT_PHASE_RUN][i] = current_scale(settings.current[i], 100);
+        current_profile[CURRENT_PHASE_BOOST][i] = current_scale(settings.current[i], boost_percent[i]);
+    }
+    current_phase = CURRENT_N_PHASES; // Force a write of the active phase.
+    current_update();
+}
+
+void current_update()
+{
+    uint8_t phase = st_get_current_phase();
+    // Keep the run current while the segment buffer runs empty in the middle of a motion.
+    if ((phase == CURRENT_PHASE_IDLE) && (sys.state & (STATE_CYCLE | STATE_HOMING | STATE_JOG))) {
+        phase = CURRENT_PHASE_RUN;
+    }
+    if (phase == current_phase) { return; }
+    current_phase = phase;
+
+    uint8_t i;
+    for (i = 0; i < N_AXIS; i++) {
+        set_current(i, current_profile[phase][i]);
+    }
 }
 
+#else
+
 inline static uint8_t spi_transfer(uint8_t data)
 {
     SPDR = data;
@@ -65,4 +174,6 @@ void set_current(uint8_t motor, uint8_t value)
     DIGIPOTSS_PORT |= (1<<DIGIPOTSS_BIT);
 }
 
+#endif // MOTOR_CURRENT_PROFILES
+
 #endif // HAS_DIGIPOTS
@@ -22,5 +22,17 @@
 
 #include <stdint.h>
 
+// Motor current phases of MOTOR_CURRENT_PROFILES, in the order of increasing current.
+#define CURRENT_PHASE_IDLE 0 // At rest or holding.
+#define CURRENT_PHASE_RUN 1 // Cruising. The $14x run current.
+#define CURRENT_PHASE_BOOST 2 // Accelerating or decelerating.
+#define CURRENT_N_PHASES 3
+
 void current_init();
 void set_current(uint8_t motor, uint8_t value);
+
+// Rebuilds the current profiles from the $14x run currents and applies the active phase.
+void current_load_profiles();
+
+// Applies the current profile of the motion phase of the segment buffer. Called from the main loop.
+void current_update();
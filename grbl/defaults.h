@@ -508,4 +508,12 @@
   #define DEFAULT_HOMING_PULLOFF 3.0 // mm
 #endif
 
+// Defaults of settings added after the machine defaults above. Machines may define their own.
+#ifndef DEFAULT_ROTARY_JUNCTION_DEVIATION
+  #define DEFAULT_ROTARY_JUNCTION_DEVIATION 0.2 // degrees
+#endif
+#ifndef DEFAULT_ROTARY_WRAP_MASK
+  #define DEFAULT_ROTARY_WRAP_MASK 0 // No axis wraps
+#endif
+
 #endif
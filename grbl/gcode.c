@@ -59,6 +59,47 @@ void gc_sync_position()
 }
 
 
+// Moves the absolute targets of wrapped rotary axes to within half a turn of the current position,
+// so they are reached the shortest way around. Incremental moves are left as programmed and select
+// the direction and number of turns instead.
+static void gc_wrap_target(float *target, float *position, uint8_t axis_mask)
+{
+  uint8_t idx;
+  axis_mask &= settings.rotary_wrap_mask;
+  for (idx=0; idx<N_AXIS; idx++) {
+    if (bit_istrue(axis_mask,bit(idx))) {
+      float delta = target[idx]-position[idx];
+      target[idx] = position[idx]+(delta-360.0*lround(delta/360.0));
+    }
+  }
+}
+
+
+// Brings the parser position of wrapped rotary axes back within [0,360) degrees after a motion. The
+// planner and machine positions are shifted by the same number of turns, which only moves their
+// origin, so motions already buffered are unaffected.
+// NOTE: A turn is rounded to whole steps for the planner and machine positions. The steps per degree
+// setting of a wrapped axis should make a turn a whole number of steps.
+static void gc_wrap_position()
+{
+  uint8_t idx;
+  for (idx=0; idx<N_AXIS; idx++) {
+    if (bit_istrue(settings.rotary_wrap_mask,bit(idx))) {
+      int32_t turns = floor(gc_state.position[idx]/360.0);
+      if (turns) {
+        gc_state.position[idx] -= 360.0*turns;
+        int32_t steps = turns*lround(360.0*settings.steps_per_mm[idx]);
+        plan_shift_position(idx, steps);
+        uint8_t sreg = SREG;
+        cli();
+        sys_position[idx] -= steps;
+        SREG = sreg;
+      }
+    }
+  }
+}
+
+
 // Executes one line of 0-terminated G-Code. The line is assumed to contain only uppercase
 // characters and signed floating point values (no whitespace). Comments and block delete
 // characters have been removed. In this function, all units and positions are converted and
@@ -99,6 +140,10 @@ uint8_t gc_execute_line(char *line)
   uint32_t command_dwords = 0; // Tracks G and M command words. Also used for modal group violations.
   uint32_t value_dwords = 0;   // Tracks value words.
   uint8_t gc_parser_flags = GC_PARSER_NONE;
+  #ifdef LASER_RASTER
+    uint8_t raster_data = 0;  // Line index of the raster pixel data.
+    uint8_t raster_count = 0; // Raster pixels of the block.
+  #endif
 
   // Determine if the line is a jogging motion or a normal g-code block.
   if (line[0] == '$') { // NOTE: `$J=` already parsed when passed to this function.
@@ -130,6 +175,15 @@ uint8_t gc_execute_line(char *line)
     letter = line[char_counter];
     if((letter < 'A') || (letter > 'Z')) { FAIL(STATUS_EXPECTED_COMMAND_LETTER); } // [Expected word letter]
     char_counter++;
+    #ifdef LASER_RASTER
+      if (letter == 'D') { // Raster pixel data. Hex digits up to the end of the line, not a number.
+        raster_data = char_counter;
+        raster_count = raster_check_pixels(line, &char_counter);
+        if (raster_count == 0) { FAIL(STATUS_BAD_NUMBER_FORMAT); }
+        value_dwords |= dwbit(DWORD_D);
+        continue;
+      }
+    #endif
     if (!read_float(line, &char_counter, &value)) { FAIL(STATUS_BAD_NUMBER_FORMAT); } // [Expected word value]
 
     // Convert values to smaller uint8 significand and mantissa values for parsing this word.
@@ -415,6 +469,10 @@ uint8_t gc_execute_line(char *line)
     }
   }
   // Parsing complete!
+  #ifdef INDEXER_AXIS
+    // The indexer axis moves only through '$E' commands, outside of the g-code state.
+    if (axis_dwords & bit(INDEXER_AXIS)) { FAIL(STATUS_GCODE_UNSUPPORTED_COMMAND); }
+  #endif
 
 
   /* -------------------------------------------------------------------------------------
@@ -878,6 +936,11 @@ uint8_t gc_execute_line(char *line)
               }
             }
           }
+          // G53 targets are absolute too.
+          if ((gc_block.modal.distance == DISTANCE_MODE_ABSOLUTE) ||
+              (gc_block.non_modal_command == NON_MODAL_ABSOLUTE_OVERRIDE)) {
+            gc_wrap_target(gc_block.values.xyz, gc_state.position, axis_dwords);
+          }
         }
       }
 
@@ -898,8 +961,10 @@ uint8_t gc_execute_line(char *line)
             for (idx=0; idx<N_AXIS; idx++) {
               if (!(axis_dwords & (1<<idx))) { gc_block.values.ijk[idx] = gc_state.position[idx]; }
             }
+            gc_wrap_target(gc_block.values.ijk, gc_block.values.xyz, axis_dwords);
           } else {
             axis_command = AXIS_COMMAND_NONE; // Set to none if no intermediate motion.
+            gc_wrap_target(gc_block.values.ijk, gc_state.position, settings.rotary_wrap_mask);
           }
           break;
         case NON_MODAL_SET_HOME_0: // G28.1
@@ -1201,6 +1266,14 @@ uint8_t gc_execute_line(char *line)
 #else
   if (axis_command) { bit_false(value_dwords,(dwbit(DWORD_X)|dwbit(DWORD_Y)|dwbit(DWORD_Z))); } // Remove axis words.
 #endif
+  #ifdef LASER_RASTER
+    // Raster pixels are used by G1 line motions in laser mode. Elsewhere, they are unused words.
+    if (bit_istrue(value_dwords,dwbit(DWORD_D)) && (axis_command == AXIS_COMMAND_MOTION_MODE) &&
+        (gc_block.modal.motion == MOTION_MODE_LINEAR) && !(gc_parser_flags & GC_PARSER_JOG_MOTION)) {
+      if (bit_isfalse(settings.flags,BITFLAG_LASER_MODE)) { FAIL(STATUS_SETTING_DISABLED_LASER); }
+      bit_false(value_dwords,dwbit(DWORD_D));
+    }
+  #endif
   if (value_dwords) { FAIL(STATUS_GCODE_UNUSED_WORDS); } // [Unused words]
 
   /* -------------------------------------------------------------------------------------
@@ -1221,7 +1294,7 @@ uint8_t gc_execute_line(char *line)
   if (gc_parser_flags & GC_PARSER_JOG_MOTION) {
     // Only distance and unit modal commands and G53 absolute override command are allowed.
     // NOTE: Feed rate word and axis word checks have already been performed in STEP 3.
-    if (command_dwords & ~(bit(MODAL_GROUP_G3) | bit(MODAL_GROUP_G6 | bit(MODAL_GROUP_G0))) ) { FAIL(STATUS_INVALID_JOG_COMMAND) };
+    if (command_dwords & ~(bit(MODAL_GROUP_G3) | bit(MODAL_GROUP_G6) | bit(MODAL_GROUP_G0)) ) { FAIL(STATUS_INVALID_JOG_COMMAND) };
     if (!(gc_block.non_modal_command == NON_MODAL_ABSOLUTE_OVERRIDE || gc_block.non_modal_command == NON_MODAL_NO_ACTION)) { FAIL(STATUS_INVALID_JOG_COMMAND); }
 
     // Initialize planner data to current spindle and coolant modal state.
@@ -1229,7 +1302,10 @@ uint8_t gc_execute_line(char *line)
     plan_data.condition = (gc_state.modal.spindle | gc_state.modal.coolant);
 
     uint8_t status = jog_execute(&plan_data, &gc_block);
-    if (status == STATUS_OK) { memcpy(gc_state.position, gc_block.values.xyz, sizeof(gc_block.values.xyz)); }
+    if (status == STATUS_OK) {
+      memcpy(gc_state.position, gc_block.values.xyz, sizeof(gc_block.values.xyz));
+      gc_wrap_position();
+    }
     return(status);
   }
 
@@ -1279,6 +1355,12 @@ uint8_t gc_execute_line(char *line)
   gc_state.feed_rate = gc_block.values.f; // Always copy this value. See feed rate error-checking.
   pl_data->feed_rate = gc_state.feed_rate; // Record data for planner use.
 
+  #ifdef ENABLE_JOB_CHECKPOINT
+    // The first line numbered past the checkpoint ends a job replay and executes normally. The
+    // block has passed all error-checks by now, and steps 1-3 only update the parser state.
+    if (checkpoint.replay_line_number && (gc_block.values.n > checkpoint.replay_line_number)) { checkpoint_resume(); }
+  #endif
+
   // [4. Set spindle speed ]:
   if ((gc_state.spindle_speed != gc_block.values.s) || bit_istrue(gc_parser_flags,GC_PARSER_LASER_FORCE_SYNC)) {
     if (gc_state.modal.spindle != SPINDLE_DISABLE) {
@@ -1387,6 +1469,7 @@ uint8_t gc_execute_line(char *line)
       if (axis_command) { mc_line(gc_block.values.xyz, pl_data); }
       mc_line(gc_block.values.ijk, pl_data);
       memcpy(gc_state.position, gc_block.values.ijk, N_AXIS*sizeof(float));
+      gc_wrap_position();
       break;
     case NON_MODAL_SET_HOME_0:
       settings_write_coord_data(SETTING_INDEX_G28,gc_state.position);
@@ -1413,6 +1496,9 @@ uint8_t gc_execute_line(char *line)
     if (axis_command == AXIS_COMMAND_MOTION_MODE) {
       uint8_t gc_update_pos = GC_UPDATE_POS_TARGET;
       if (gc_state.modal.motion == MOTION_MODE_LINEAR) {
+        #ifdef LASER_RASTER
+          if (raster_count) { raster_queue_pixels(&line[raster_data], raster_count, pl_data); }
+        #endif
         mc_line(gc_block.values.xyz, pl_data);
       } else if (gc_state.modal.motion == MOTION_MODE_SEEK) {
         pl_data->condition |= PL_COND_FLAG_RAPID_MOTION; // Set rapid motion condition flag.
@@ -1441,6 +1527,7 @@ uint8_t gc_execute_line(char *line)
       } else if (gc_update_pos == GC_UPDATE_POS_SYSTEM) {
         gc_sync_position(); // gc_state.position[] = sys_position
       } // == GC_UPDATE_POS_NONE
+      gc_wrap_position();
     }
   }
 
@@ -1480,6 +1567,7 @@ uint8_t gc_execute_line(char *line)
         sys.f_override = DEFAULT_FEED_OVERRIDE;
         sys.r_override = DEFAULT_RAPID_OVERRIDE;
         sys.spindle_speed_ovr = DEFAULT_SPINDLE_SPEED_OVERRIDE;
+        spindle_update_pwm_override();
       #endif
 
       // Execute coordinate change and spindle/coolant stop.
@@ -157,6 +157,7 @@
 #define DWORD_U 16
 #define DWORD_V 17
 #define DWORD_W 18
+#define DWORD_D 19 // Raster pixel data. See LASER_RASTER.
 
 // Define g-code parser position updating flags
 #define GC_UPDATE_POS_TARGET   0 // Must be zero
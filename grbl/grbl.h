@@ -65,6 +65,11 @@
 #include "sleep.h"
 #include "current_control.h"
 #include "microstep_control.h"
+#include "perf.h"
+#include "checkpoint.h"
+#include "bench.h"
+#include "indexer.h"
+#include "raster.h"
 
 // ---------------------------------------------------------------------------------------
 // COMPILE-TIME ERROR CHECKING OF DEFINE VALUES:
@@ -91,6 +96,41 @@
   #endif
 #endif
 
+#ifdef SPINDLE_AT_SPEED
+  #ifndef SPINDLE_TACH_CAPT_vect
+    #error "SPINDLE_AT_SPEED requires a spindle tachometer input in the cpu map."
+  #endif
+  #ifdef INDEXER_AXIS
+    #error "SPINDLE_AT_SPEED and INDEXER_AXIS use the same timer and may not be enabled at the same time."
+  #endif
+  #if defined(CPU_MAP_2560_RAMPS_BOARD) && (N_AXIS > 5)
+    #error "SPINDLE_AT_SPEED uses the step pin of axis number 6 on Ramps 1.4."
+  #endif
+  #if (SPINDLE_TACH_PULSES_PER_REV < 1) || (SPINDLE_TACH_PULSES_PER_REV > 255)
+    #error "SPINDLE_TACH_PULSES_PER_REV must be between 1 and 255."
+  #endif
+  #if (SPINDLE_AT_SPEED_PERCENT < 1) || (SPINDLE_AT_SPEED_PERCENT > 100)
+    #error "SPINDLE_AT_SPEED_PERCENT must be between 1 and 100."
+  #endif
+#endif
+
+#ifdef MOTOR_CURRENT_PROFILES
+  #ifndef HAS_DIGIPOTS
+    #error "MOTOR_CURRENT_PROFILES requires digipot current control in the cpu map."
+  #endif
+  #if (list_length(MOTOR_CURRENT_IDLE_PERCENT) != N_AXIS) || (list_length(MOTOR_CURRENT_BOOST_PERCENT) != N_AXIS)
+    #error "MOTOR_CURRENT_IDLE_PERCENT and MOTOR_CURRENT_BOOST_PERCENT must list N_AXIS percentages."
+  #endif
+#endif
+
+#if defined(SPINDLE_PWM_CURVE) && defined(ENABLE_PIECEWISE_LINEAR_SPINDLE)
+  #error "SPINDLE_PWM_CURVE and ENABLE_PIECEWISE_LINEAR_SPINDLE may not be enabled at the same time."
+#endif
+
+#if (SPINDLE_PWM_TABLE_SIZE < 2) || (SPINDLE_PWM_TABLE_SIZE > 256)
+  #error "SPINDLE_PWM_TABLE_SIZE must be between 2 and 256."
+#endif
+
 #if (REPORT_WCO_REFRESH_BUSY_COUNT < REPORT_WCO_REFRESH_IDLE_COUNT)
   #error "WCO busy refresh is less than idle refresh."
 #endif
@@ -104,6 +144,65 @@
   #error "Override refresh must be greater than zero."
 #endif
 
+#if (BAUD_RATE > 1000000)
+  #error "BAUD_RATE above 1000000 overruns the serial receive interrupt. See config.h."
+#endif
+#if defined(ENABLE_XONXOFF) && defined(ENABLE_RTS_FLOW_CONTROL)
+  #error "ENABLE_XONXOFF and ENABLE_RTS_FLOW_CONTROL can not be enabled at the same time."
+#endif
+#if defined(ENABLE_RTS_FLOW_CONTROL) && !defined(SERIAL_RTS_BIT)
+  #error "ENABLE_RTS_FLOW_CONTROL requires a SERIAL_RTS pin defined in cpu_map.h."
+#endif
+#ifdef SERIAL_FLOW_CONTROL
+  #if (RX_BUFFER_FLOW_LOW < 1) || (RX_BUFFER_FLOW_LOW >= RX_BUFFER_FLOW_HIGH) || (RX_BUFFER_FLOW_HIGH >= RX_BUFFER_SIZE)
+    #error "Serial flow control watermarks must satisfy 0 < RX_BUFFER_FLOW_LOW < RX_BUFFER_FLOW_HIGH < RX_BUFFER_SIZE."
+  #endif
+#endif
+#if (TX_BUFFER_SIZE < REPORT_LINE_MAX)
+  #error "TX_BUFFER_SIZE must hold a complete report line, REPORT_LINE_MAX in report.h."
+#endif
+
+#if (PLANNER_OVERRIDE_SLICE_BLOCKS < 2)
+  #error "PLANNER_OVERRIDE_SLICE_BLOCKS must be at least 2."
+#endif
+
+#if defined(BENCHMARK) && !defined(ENABLE_PERFORMANCE_COUNTERS)
+  #error "BENCHMARK requires ENABLE_PERFORMANCE_COUNTERS to time the stepper ISR."
+#endif
+#if defined(COREXY) && (defined(AXIS_4_MASTER) || defined(AXIS_5_MASTER) || defined(AXIS_6_MASTER))
+  #error "GANGED_AXES is not supported with COREXY. Rename the cloned axes or disable GANGED_AXES."
+#endif
+#if defined(SEGMENT_CRUISE_TIME_SCALE) && ((SEGMENT_CRUISE_TIME_SCALE < 2) || (SEGMENT_CRUISE_TIME_SCALE > 6))
+  #error "SEGMENT_CRUISE_TIME_SCALE must be an integer from 2 to 6."
+#endif
+#if defined(STEP_RATE_RAMPS) && !defined(ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING)
+  #error "STEP_RATE_RAMPS requires ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING for a fixed Timer1 prescaler."
+#endif
+#if defined(ENABLE_PERFORMANCE_COUNTERS) && !defined(ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING)
+  #error "ENABLE_PERFORMANCE_COUNTERS requires ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING for a fixed Timer1 prescaler."
+#endif
+#ifdef INDEXER_AXIS
+  #ifndef INDEXER_TCCRB_REGISTER
+    #error "INDEXER_AXIS needs a spare timer, which the selected cpu map doesn't define."
+  #endif
+  #if (INDEXER_AXIS < 3) || (INDEXER_AXIS >= N_AXIS)
+    #error "INDEXER_AXIS must be one of the axes 4 to N_AXIS."
+  #endif
+  #if (INDEXER_AXIS_NAME == AXIS_1_NAME) || (INDEXER_AXIS_NAME == AXIS_2_NAME) || (INDEXER_AXIS_NAME == AXIS_3_NAME)
+    #error "INDEXER_AXIS must have a letter of its own. Rename it in config.h."
+  #endif
+  #if ((N_AXIS > 3) && (INDEXER_AXIS != AXIS_4) && (INDEXER_AXIS_NAME == AXIS_4_NAME)) || \
+      ((N_AXIS > 4) && (INDEXER_AXIS != AXIS_5) && (INDEXER_AXIS_NAME == AXIS_5_NAME)) || \
+      ((N_AXIS > 5) && (INDEXER_AXIS != AXIS_6) && (INDEXER_AXIS_NAME == AXIS_6_NAME))
+    #error "INDEXER_AXIS must have a letter of its own. Rename it in config.h."
+  #endif
+  #if (defined(HOMING_CYCLE_0) && (HOMING_CYCLE_0 & (1<<INDEXER_AXIS))) || (defined(HOMING_CYCLE_1) && (HOMING_CYCLE_1 & (1<<INDEXER_AXIS))) || \
+      (defined(HOMING_CYCLE_2) && (HOMING_CYCLE_2 & (1<<INDEXER_AXIS))) || (defined(HOMING_CYCLE_3) && (HOMING_CYCLE_3 & (1<<INDEXER_AXIS))) || \
+      (defined(HOMING_CYCLE_4) && (HOMING_CYCLE_4 & (1<<INDEXER_AXIS))) || (defined(HOMING_CYCLE_5) && (HOMING_CYCLE_5 & (1<<INDEXER_AXIS)))
+    #error "INDEXER_AXIS can't be homed. Remove it from the homing cycles."
+  #endif
+#endif
+
 // ---------------------------------------------------------------------------------------
 
 #endif
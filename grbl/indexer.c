@@ -0,0 +1,290 @@
+/*
+  indexer.c - independent step generator for one axis on a spare timer
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  The indexer moves one axis through its own queue of point-to-point moves and its own timer
+  interrupt, so it runs alongside the planner and the stepper ISR without sharing either. Each move
+  starts and ends at rest with a trapezoidal profile. Step periods are timed with the real-time
+  approximation by D. Austin ("Generate stepper-motor speed profiles in real time", 2005): every
+  period of a ramp follows from the previous one with a single integer division, so the ISR needs no
+  floats or square roots. The main program computes the first and the cruise periods and the ramp
+  length when a move is queued.
+    Ramps are counted in steps from rest. When the first period from rest is longer than the timer
+  can count, the move starts further up the ramp, at the first step period that fits, and ends as
+  far down the deceleration ramp.
+*/
+
+#include "grbl.h"
+
+#ifdef INDEXER_AXIS
+
+#define INDEXER_PERIOD_SHIFT 8 // Fractional bits of the step periods, so ramp round-off doesn't add up.
+#define INDEXER_MAX_PERIOD 0xffff // Timer ticks.
+#define INDEXER_MIN_PERIOD (INDEXER_TICKS_PER_SECOND/INDEXER_MAX_STEP_RATE) // Timer ticks.
+
+// The stepper disable pin macros paste their argument, so expand the axis index first.
+#define INDEXER_DISABLE_PORT_(i) STEPPER_DISABLE_PORT(i)
+#define INDEXER_DISABLE_BIT_(i) STEPPER_DISABLE_BIT(i)
+#define INDEXER_DISABLE_PORT INDEXER_DISABLE_PORT_(INDEXER_AXIS)
+#define INDEXER_DISABLE_BIT INDEXER_DISABLE_BIT_(INDEXER_AXIS)
+
+typedef struct {
+  uint32_t step_count;    // Steps of the move.
+  uint32_t ramp_steps;    // Steps of the acceleration ramp. The deceleration ramp is as long.
+  uint32_t ramp_start;    // Steps from rest where the ramps start. Zero unless the timer can't time the first step.
+  uint32_t first_period;  // Step period at the start of the ramp. Scaled by INDEXER_PERIOD_SHIFT.
+  uint32_t cruise_period; // Step period at the move rate. Scaled by INDEXER_PERIOD_SHIFT.
+  uint8_t direction_bits; // Direction pin output with the invert mask applied.
+  uint8_t is_negative;    // Move is in the negative direction.
+} indexer_move_t;
+
+// Move queue ring buffer. The head is written by the main program and the tail by the indexer ISR.
+static indexer_move_t indexer_queue[INDEXER_QUEUE_SIZE];
+static volatile uint8_t indexer_queue_head;
+static volatile uint8_t indexer_queue_tail;
+static int32_t indexer_queue_position; // Machine position in steps after the queued moves.
+
+// Indexer ISR data. Only written by the main program while the indexer is stopped.
+typedef struct {
+  indexer_move_t move; // Executing move.
+  uint32_t step_index; // Steps executed of the move.
+  uint32_t period;     // Period until the next step. Scaled by INDEXER_PERIOD_SHIFT.
+  uint8_t step_bits;   // Step pin output at the pulse, with the invert mask applied.
+  uint8_t step_idle_bits;
+  uint16_t pulse_ticks; // Step pulse time in timer ticks.
+  uint8_t busy;
+} indexer_t;
+static indexer_t indexer;
+static volatile uint8_t indexer_running;
+
+
+static uint8_t indexer_next_queue_index(uint8_t index)
+{
+  if (++index == INDEXER_QUEUE_SIZE) { index = 0; }
+  return(index);
+}
+
+
+// Starts the next queued move. Called with interrupts disabled.
+static void indexer_load_move()
+{
+  memcpy(&indexer.move, &indexer_queue[indexer_queue_tail], sizeof(indexer_move_t));
+  indexer_queue_tail = indexer_next_queue_index(indexer_queue_tail);
+  indexer.step_index = 0;
+  indexer.period = indexer.move.first_period;
+  DIRECTION_PORT(INDEXER_AXIS) = (DIRECTION_PORT(INDEXER_AXIS) & ~(1<<DIRECTION_BIT(INDEXER_AXIS))) | indexer.move.direction_bits;
+}
+
+
+static void indexer_set_disable_pin(uint8_t pin_state)
+{
+  uint8_t sreg = SREG;
+  cli();
+  if (pin_state) { INDEXER_DISABLE_PORT |= (1<<INDEXER_DISABLE_BIT); }
+  else { INDEXER_DISABLE_PORT &= ~(1<<INDEXER_DISABLE_BIT); }
+  SREG = sreg;
+}
+
+
+void indexer_init()
+{
+  INDEXER_TIMSK_REGISTER &= ~(1<<INDEXER_OCIE_BIT);
+  INDEXER_TCCRA_REGISTER = 0;
+  INDEXER_TCCRB_REGISTER = 0; // Stopped.
+}
+
+
+void indexer_reset()
+{
+  indexer_stop();
+  indexer_queue_head = 0;
+  indexer_queue_tail = 0;
+  indexer.busy = false;
+}
+
+
+uint8_t indexer_stop()
+{
+  uint8_t sreg = SREG;
+  cli();
+  uint8_t was_running = indexer_running;
+  INDEXER_TIMSK_REGISTER &= ~(1<<INDEXER_OCIE_BIT);
+  INDEXER_TCCRB_REGISTER = 0;
+  indexer_running = false;
+  indexer_queue_tail = indexer_queue_head;
+  if (was_running) {
+    STEP_PORT(INDEXER_AXIS) = (STEP_PORT(INDEXER_AXIS) & ~(1<<STEP_BIT(INDEXER_AXIS))) | indexer.step_idle_bits;
+  }
+  SREG = sreg;
+  return(was_running);
+}
+
+
+uint8_t indexer_is_moving() { return(indexer_running); }
+
+
+void indexer_go_idle(uint8_t pin_state)
+{
+  if (!indexer_running) { indexer_set_disable_pin(pin_state); }
+}
+
+
+uint8_t indexer_queue_move(float target, float rate)
+{
+  float steps_per_mm = settings.steps_per_mm[INDEXER_AXIS];
+  if (bit_istrue(settings.flags,BITFLAG_SOFT_LIMIT_ENABLE)) {
+    float limit_target[N_AXIS];
+    memset(limit_target, 0, sizeof(limit_target)); // Other axes at zero always pass.
+    limit_target[INDEXER_AXIS] = target;
+    if (system_check_travel_limits(limit_target)) { return(STATUS_TRAVEL_EXCEEDED); }
+  }
+
+  // Moves follow on from the last queued one, or from the current position when stopped.
+  if (!indexer_running) {
+    uint8_t sreg = SREG;
+    cli();
+    indexer_queue_position = sys_position[INDEXER_AXIS];
+    SREG = sreg;
+  }
+  int32_t target_steps = lround(target*steps_per_mm);
+  if (target_steps == indexer_queue_position) { return(STATUS_OK); }
+
+  indexer_move_t move;
+  move.is_negative = (target_steps < indexer_queue_position);
+  move.step_count = labs(target_steps-indexer_queue_position);
+  move.direction_bits = (move.is_negative ? (1<<DIRECTION_BIT(INDEXER_AXIS)) : 0);
+  if (bit_istrue(settings.dir_invert_mask,bit(INDEXER_AXIS))) { move.direction_bits ^= (1<<DIRECTION_BIT(INDEXER_AXIS)); }
+
+  // Compute the cruise period, then the ramp from rest to it. Rates in steps/sec and steps/sec^2.
+  if ((rate <= 0.0) || (rate > settings.max_rate[INDEXER_AXIS])) { rate = settings.max_rate[INDEXER_AXIS]; }
+  float cruise_period = INDEXER_TICKS_PER_SECOND/(rate*steps_per_mm*(1.0/60.0));
+  // NOTE: The ISR holds the step pulse, so the period also leaves time for the pulse and the ISR itself.
+  float min_period = max(INDEXER_MIN_PERIOD, 2.0*settings.pulse_microseconds*(INDEXER_TICKS_PER_SECOND/1000000));
+  cruise_period = min(max(cruise_period, min_period), INDEXER_MAX_PERIOD);
+  float step_rate = INDEXER_TICKS_PER_SECOND/cruise_period;
+  float acceleration = settings.acceleration[INDEXER_AXIS]*steps_per_mm*(1.0/3600.0);
+  float ramp_time = INDEXER_TICKS_PER_SECOND*sqrt(2.0/acceleration); // Ticks to the first step from rest.
+  float first_period = 0.676*ramp_time; // Austin's correction for the first step.
+  move.ramp_start = 0;
+  if (first_period > INDEXER_MAX_PERIOD) {
+    // The n-th period of a ramp is ramp_time*(sqrt(n+1)-sqrt(n)). Start at the first that fits.
+    float ramp_start = ramp_time/(2.0*INDEXER_MAX_PERIOD);
+    move.ramp_start = ceil(ramp_start*ramp_start);
+    first_period = ramp_time/(sqrt(move.ramp_start+1.0)+sqrt(move.ramp_start));
+  }
+  float ramp_steps = step_rate*step_rate/(2.0*acceleration) - move.ramp_start;
+  if ((first_period <= cruise_period) || (ramp_steps < 1.0)) {
+    first_period = cruise_period; // Slow enough to start and stop without a ramp.
+    move.ramp_steps = 0;
+  } else {
+    move.ramp_steps = min(ramp_steps, move.step_count/2);
+  }
+  move.first_period = (uint32_t)first_period << INDEXER_PERIOD_SHIFT;
+  move.cruise_period = (uint32_t)cruise_period << INDEXER_PERIOD_SHIFT;
+
+  // Wait for room in the queue. Coordinated motion keeps running meanwhile.
+  uint8_t next_head = indexer_next_queue_index(indexer_queue_head);
+  while (next_head == indexer_queue_tail) {
+    protocol_execute_realtime();
+    if (sys.abort) { return(STATUS_OK); }
+  }
+  memcpy(&indexer_queue[indexer_queue_head], &move, sizeof(indexer_move_t));
+  indexer_queue_head = next_head;
+  indexer_queue_position = target_steps;
+
+  // Start the indexer, if stopped. The first step follows after the first period.
+  uint8_t sreg = SREG;
+  cli();
+  if (!indexer_running) {
+    indexer_running = true;
+    indexer_set_disable_pin(bit_istrue(settings.flags,BITFLAG_INVERT_ST_ENABLE)); // Enable motor.
+    indexer.step_idle_bits = 0;
+    if (bit_istrue(settings.step_invert_mask,bit(INDEXER_AXIS))) { indexer.step_idle_bits = (1<<STEP_BIT(INDEXER_AXIS)); }
+    indexer.step_bits = indexer.step_idle_bits ^ (1<<STEP_BIT(INDEXER_AXIS));
+    indexer.pulse_ticks = settings.pulse_microseconds*(INDEXER_TICKS_PER_SECOND/1000000);
+    indexer_load_move();
+    INDEXER_TCNT_REGISTER = 0;
+    INDEXER_OCR_REGISTER = (indexer.period >> INDEXER_PERIOD_SHIFT)-1;
+    INDEXER_TIFR_REGISTER = (1<<INDEXER_OCF_BIT);
+    INDEXER_TCCRB_REGISTER = INDEXER_TCCRB_INIT_MASK;
+    INDEXER_TIMSK_REGISTER |= (1<<INDEXER_OCIE_BIT);
+  }
+  SREG = sreg;
+  return(STATUS_OK);
+}
+
+
+void indexer_synchronize()
+{
+  while (indexer_running) {
+    protocol_execute_realtime();
+    if (sys.abort) { return; }
+  }
+}
+
+
+// Executes one step of the indexer move and times the next. Re-enables interrupts after the step,
+// like the stepper ISR, so the ramp division never delays a stepper ISR by more than a few cycles.
+// NOTE: Port updates are made with interrupts disabled, since the step and direction pins may share
+// ports with the other axes.
+ISR(INDEXER_COMPA_vect)
+{
+  if (indexer.busy) { return; }
+  STEP_PORT(INDEXER_AXIS) = (STEP_PORT(INDEXER_AXIS) & ~(1<<STEP_BIT(INDEXER_AXIS))) | indexer.step_bits;
+  indexer.busy = true;
+  sei();
+
+  if (indexer.move.is_negative) { sys_position[INDEXER_AXIS]--; }
+  else { sys_position[INDEXER_AXIS]++; }
+  indexer.step_index++;
+  uint32_t steps_left = indexer.move.step_count-indexer.step_index;
+  uint32_t period = indexer.period;
+  if (steps_left <= indexer.move.ramp_steps) {
+    // Deceleration ramp. Mirrors the acceleration ramp down to the steps left.
+    uint32_t n = steps_left+indexer.move.ramp_start;
+    if (n) { period += (period << 1)/((n << 2)-1); }
+    if (period > ((uint32_t)INDEXER_MAX_PERIOD << INDEXER_PERIOD_SHIFT)) { period = (uint32_t)INDEXER_MAX_PERIOD << INDEXER_PERIOD_SHIFT; }
+  } else if (period > indexer.move.cruise_period) {
+    // Acceleration ramp.
+    uint32_t n = indexer.step_index+indexer.move.ramp_start;
+    period -= (period << 1)/((n << 2)+1);
+    if (period < indexer.move.cruise_period) { period = indexer.move.cruise_period; }
+  }
+
+  // Hold the step pulse for its full time. The timer counts from zero since this interrupt.
+  while (INDEXER_TCNT_REGISTER < indexer.pulse_ticks) { }
+
+  cli();
+  STEP_PORT(INDEXER_AXIS) = (STEP_PORT(INDEXER_AXIS) & ~(1<<STEP_BIT(INDEXER_AXIS))) | indexer.step_idle_bits;
+  if (steps_left == 0) {
+    if (indexer_queue_tail != indexer_queue_head) {
+      indexer_load_move();
+      period = indexer.period;
+    } else {
+      // Queue empty. Stop.
+      INDEXER_TIMSK_REGISTER &= ~(1<<INDEXER_OCIE_BIT);
+      INDEXER_TCCRB_REGISTER = 0;
+      indexer_running = false;
+    }
+  }
+  indexer.period = period;
+  INDEXER_OCR_REGISTER = (period >> INDEXER_PERIOD_SHIFT)-1;
+  indexer.busy = false;
+}
+
+#endif
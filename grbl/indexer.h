@@ -0,0 +1,77 @@
+/*
+  indexer.h - independent step generator for one axis on a spare timer
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef indexer_h
+#define indexer_h
+
+#include "grbl.h"
+
+
+// Moves queued behind the executing one. '$E=' waits for room when the queue is full.
+#ifndef INDEXER_QUEUE_SIZE
+  #define INDEXER_QUEUE_SIZE 4
+#endif
+
+// Highest indexer step rate. Keeps the step period longer than the indexer ISR, which divides once
+// per step while ramping, plus a stepper ISR that may interrupt it.
+#ifndef INDEXER_MAX_STEP_RATE
+  #define INDEXER_MAX_STEP_RATE 5000 // (steps/sec)
+#endif
+
+#ifdef INDEXER_AXIS
+  #if INDEXER_AXIS == 3
+    #define INDEXER_AXIS_NAME AXIS_4_NAME
+  #elif INDEXER_AXIS == 4
+    #define INDEXER_AXIS_NAME AXIS_5_NAME
+  #else
+    #define INDEXER_AXIS_NAME AXIS_6_NAME
+  #endif
+#endif
+
+// True for the axis whose pins belong to the indexer. The stepper ISR leaves them alone.
+#ifdef INDEXER_AXIS
+  #define INDEXER_DRIVES_AXIS(idx) ((idx) == INDEXER_AXIS)
+#else
+  #define INDEXER_DRIVES_AXIS(idx) 0
+#endif
+
+
+// Sets up the indexer timer. Called once at power-up.
+void indexer_init();
+
+// Stops the indexer and clears the move queue. Called upon a system abort.
+void indexer_reset();
+
+// Stops the indexer at once. Returns true, if it was moving. Called by mc_reset(), also from
+// interrupts.
+uint8_t indexer_stop();
+
+// Returns true while the indexer executes or has queued moves.
+uint8_t indexer_is_moving();
+
+// Applies the stepper idle state from st_go_idle() to the indexer motor, unless it is moving.
+void indexer_go_idle(uint8_t pin_state);
+
+// Queues a move of the indexer axis to an absolute machine position. A rate of zero moves at the
+// axis maximum rate. Waits for room in the queue, but not for the move.
+uint8_t indexer_queue_move(float target, float rate);
+
+// Waits until the indexer has stopped.
+void indexer_synchronize();
+
+#endif
@@ -44,12 +44,37 @@ uint8_t axis_W_mask = 0; // Global mask for axis C bits
   volatile uint8_t sys_rt_exec_debug;
 #endif
 
+#ifdef ENABLE_PERFORMANCE_COUNTERS
+  // Paints all RAM above the static variables before the C runtime starts, so the stack high-water
+  // mark can be found later by scanning for the first overwritten byte. Runs from the .init1 section
+  // before the stack is in use. Written in assembly, since r1 is not cleared yet.
+  void main_paint_stack() __attribute__((naked, used, section(".init1")));
+  void main_paint_stack()
+  {
+    __asm__ __volatile__ (
+      "    ldi r30, lo8(_end)  \n"
+      "    ldi r31, hi8(_end)  \n"
+      "    ldi r24, %[paint]   \n"
+      "    ldi r25, hi8(__stack) \n"
+      "    rjmp 2f             \n"
+      "1:  st Z+, r24          \n"
+      "2:  cpi r30, lo8(__stack) \n"
+      "    cpc r31, r25        \n"
+      "    brlo 1b             \n"
+      "    breq 1b             \n"
+      :: [paint] "M" (PERF_STACK_PAINT) );
+  }
+#endif
+
 
 int main(void)
 {
   // Initialize system upon power-up.
   serial_init();   // Setup serial baud rate and interrupts
   settings_init(); // Load Grbl settings from EEPROM
+#ifdef ENABLE_JOB_CHECKPOINT
+  checkpoint_init(); // Load job checkpoint from EEPROM
+#endif
 #if HAS_DIGIPOTS
   current_init();  // Configure stepper driver current
 #endif
@@ -58,6 +83,12 @@ int main(void)
 #endif
   stepper_init();  // Configure stepper pins and interrupt timers
   system_init();   // Configure pinout pins and pin-change interrupt
+#ifdef ENABLE_PERFORMANCE_COUNTERS
+  perf_init();     // Start main loop timer and clear performance counters
+#endif
+#ifdef INDEXER_AXIS
+  indexer_init();  // Configure indexer timer
+#endif
 
   // Initialize axis mask bits (ability to axis renaming and cloning)
   if (AXIS_1_NAME == 'X') axis_X_mask |= (1<<AXIS_1);
@@ -203,6 +234,9 @@ int main(void)
   // will return to this loop to be cleanly re-initialized.
   for(;;) {
 
+    // Drop any incomplete '$' report upon a reset. One started at power-up is finished.
+    if (sys.abort) { report_reset(); }
+
     // Reset system variables.
     uint8_t prior_state = sys.state;
     memset(&sys, 0, sizeof(system_t)); // Clear system struct variable.
@@ -225,6 +259,15 @@ int main(void)
     limits_init();
     probe_init();
     sleep_init();
+    #ifdef ENABLE_JOB_CHECKPOINT
+      checkpoint_reset();
+    #endif
+    #ifdef INDEXER_AXIS
+      indexer_reset();
+    #endif
+    #ifdef LASER_RASTER
+      raster_reset();
+    #endif
     plan_reset(); // Clear block buffer and planner variables
     st_reset(); // Clear stepper subsystem variables.
 
@@ -235,6 +278,10 @@ int main(void)
     // Print welcome message. Indicates an initialization has occured at power-up or with a reset.
     report_init_message();
 
+    #ifdef BENCHMARK
+      bench_run(); // Never returns.
+    #endif
+
     // Start Grbl main loop. Processes program inputs and executes them.
     protocol_main_loop();
 
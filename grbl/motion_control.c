@@ -537,5 +537,14 @@ void mc_reset()
       } else { system_set_exec_alarm(EXEC_ALARM_ABORT_CYCLE); }
       st_go_idle(); // Force kill steppers. Position has likely been lost.
     }
+    #ifdef INDEXER_AXIS
+      // The indexer moves in any state. Stopping it mid-move also loses position.
+      if (indexer_stop()) {
+        if (!sys_rt_exec_alarm) { system_set_exec_alarm(EXEC_ALARM_ABORT_CYCLE); }
+      }
+    #endif
+    #ifdef ENABLE_JOB_CHECKPOINT
+      if (sys.state & (STATE_CYCLE | STATE_HOLD | STATE_SAFETY_DOOR)) { checkpoint_interrupt(); }
+    #endif
   }
 }
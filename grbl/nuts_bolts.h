@@ -35,6 +35,37 @@
  #define B_MOTOR AXIS_2 // Must be AXIS_2 (Y)
 #endif
 
+// Ganged motor assignments, derived from the axis names. See GANGED_AXES in config.h.
+#ifdef GANGED_AXES
+  #if N_AXIS > 3
+    #if AXIS_4_NAME == AXIS_1_NAME
+      #define AXIS_4_MASTER AXIS_1
+    #elif AXIS_4_NAME == AXIS_2_NAME
+      #define AXIS_4_MASTER AXIS_2
+    #elif AXIS_4_NAME == AXIS_3_NAME
+      #define AXIS_4_MASTER AXIS_3
+    #endif
+  #endif
+  #if N_AXIS > 4
+    #if AXIS_5_NAME == AXIS_1_NAME
+      #define AXIS_5_MASTER AXIS_1
+    #elif AXIS_5_NAME == AXIS_2_NAME
+      #define AXIS_5_MASTER AXIS_2
+    #elif AXIS_5_NAME == AXIS_3_NAME
+      #define AXIS_5_MASTER AXIS_3
+    #endif
+  #endif
+  #if N_AXIS > 5
+    #if AXIS_6_NAME == AXIS_1_NAME
+      #define AXIS_6_MASTER AXIS_1
+    #elif AXIS_6_NAME == AXIS_2_NAME
+      #define AXIS_6_MASTER AXIS_2
+    #elif AXIS_6_NAME == AXIS_3_NAME
+      #define AXIS_6_MASTER AXIS_3
+    #endif
+  #endif
+#endif
+
 // Conversions
 #define MM_PER_INCH (25.40)
 #define INCH_PER_MM (0.0393701)
@@ -50,9 +81,13 @@
 #define max(a,b) (((a) > (b)) ? (a) : (b))
 #define min(a,b) (((a) < (b)) ? (a) : (b))
 #define isequal_position_vector(a,b) !(memcmp(a, b, sizeof(float)*N_AXIS))
+// Counts the entries of a '{ ... }' list macro, up to 9, for preprocessor checks. Braces do not
+// group macro arguments, so each comma-separated entry counts once.
+#define list_length(...) list_length_pick(__VA_ARGS__,9,8,7,6,5,4,3,2,1,0)
+#define list_length_pick(a1,a2,a3,a4,a5,a6,a7,a8,a9,n,...) n
 
 // Bit field and masking macros
-#define bit(n) (1 << n)
+#define bit(n) (1 << (n))
 #define dwbit(n) ((uint32_t)1 << n)
 #define bit_true(x,mask) (x) |= (mask)
 #define bit_false(x,mask) (x) &= ~(mask)
@@ -0,0 +1,92 @@
+/*
+  perf.c - runtime performance counters for profiling a running job
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "grbl.h"
+
+#ifdef ENABLE_PERFORMANCE_COUNTERS
+
+volatile perf_t perf;
+
+static uint16_t perf_loop_timestamp;
+static uint8_t perf_loop_skip;
+
+extern uint8_t _end; // End of the static variables. Defined by the linker.
+
+// Bytes just below the stack pointer left unpainted by perf_reset(). The repaint loop runs with
+// interrupts disabled and calls nothing, so this is only a safety margin.
+#define PERF_STACK_REPAINT_MARGIN 16
+
+
+void perf_init()
+{
+  // Run Timer3 free at a 1/64 prescaler (4usec/tick, 262msec wrap). This is the same configuration
+  // sleep_init() uses. The sleep timer also clears TCNT3 when it starts counting, which breaks the
+  // iteration being timed, so it drops that sample with perf_skip_main_loop_sample().
+  // NOTE: Main loop iterations longer than the wrap period are aliased into a shorter time.
+  TCCR3A = 0;
+  TCCR3B = (1<<CS31)|(1<<CS30);
+  perf_loop_timestamp = TCNT3;
+  perf_reset();
+}
+
+
+void perf_reset()
+{
+  uint8_t sreg = SREG;
+  cli();
+  memset((perf_t *)&perf, 0, sizeof(perf_t));
+  uint8_t *ptr = &_end;
+  uint8_t *stack_limit = (uint8_t *)SP - PERF_STACK_REPAINT_MARGIN;
+  while (ptr < stack_limit) { *ptr++ = PERF_STACK_PAINT; }
+  SREG = sreg;
+}
+
+
+uint16_t perf_get_free_ram()
+{
+  return((uint8_t *)SP - &_end);
+}
+
+
+uint16_t perf_get_stack_free_min()
+{
+  uint8_t *ptr = &_end;
+  while ((ptr <= (uint8_t *)RAMEND) && (*ptr == PERF_STACK_PAINT)) { ptr++; }
+  return(ptr - &_end);
+}
+
+
+void perf_sample_main_loop()
+{
+  uint16_t timestamp = TCNT3;
+  uint16_t elapsed = timestamp - perf_loop_timestamp;
+  perf_loop_timestamp = timestamp;
+  if (perf_loop_skip) {
+    perf_loop_skip = false;
+    return;
+  }
+  PERF_SAMPLE(perf.loop_max, perf.loop_avg, elapsed);
+}
+
+
+void perf_skip_main_loop_sample()
+{
+  perf_loop_skip = true;
+}
+
+#endif
@@ -0,0 +1,76 @@
+/*
+  perf.h - runtime performance counters for profiling a running job
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef perf_h
+#define perf_h
+
+#include "grbl.h"
+
+
+// Averages are exponential moving averages with a weight of 1/2^PERF_AVG_SHIFT per sample. They
+// are stored scaled by 2^PERF_AVG_SHIFT to retain the fractional part.
+#define PERF_AVG_SHIFT 4
+
+// Main loop iterations are timed with Timer3 at a 1/64 prescaler, shared with the sleep timer.
+#define PERF_LOOP_TICKS_PER_MICROSECOND (TICKS_PER_MICROSECOND/64.0)
+
+// Free RAM is painted with this value at power-up. See main_paint_stack() in main.c.
+#define PERF_STACK_PAINT 0xC5
+
+// Updates a worst-case and moving-average pair with a new sample.
+#define PERF_SAMPLE(max_value, avg_value, sample) { \
+  if ((sample) > (max_value)) { (max_value) = (sample); } \
+  (avg_value) -= ((avg_value) >> PERF_AVG_SHIFT); (avg_value) += (sample); }
+
+typedef struct {
+  uint16_t step_isr_max;      // Worst-case stepper ISR duration in Timer1 ticks (CPU cycles).
+  uint32_t step_isr_avg;      // Average stepper ISR duration. Scaled.
+  uint16_t segment_underrun;  // Stepper ISR ran out of segments while planner blocks were queued.
+  uint16_t planner_empty;     // Planner buffer drained during a cycle. Includes the end of a job.
+  uint16_t loop_max;          // Worst-case main loop iteration in Timer3 ticks.
+  uint32_t loop_avg;          // Average main loop iteration. Scaled.
+  uint8_t recalc_max;         // Longest planner_recalculate() pass in blocks.
+  uint16_t recalc_avg;        // Average planner_recalculate() pass. Scaled.
+  uint16_t block_time_limited; // Blocks planned slower to last MINIMUM_BLOCK_TIME.
+  uint16_t rx_overflow;       // Serial characters dropped on a full RX buffer.
+} perf_t;
+extern volatile perf_t perf;
+
+
+// Starts the main loop timer and clears all counters. Called once at power-up, so the counters
+// survive soft-resets.
+void perf_init();
+
+// Clears all counters and repaints the free RAM below the stack.
+void perf_reset();
+
+// Returns the number of free RAM bytes between the static variables and the stack pointer.
+uint16_t perf_get_free_ram();
+
+// Returns the smallest amount of free RAM left by the stack since power-up or the last reset.
+// NOTE: Bytes the stack wrote with the paint value are counted as free, so the result may be high by
+// a few bytes.
+uint16_t perf_get_stack_free_min();
+
+// Records the time since the previous call as one main loop iteration.
+void perf_sample_main_loop();
+
+// Drops the next main loop sample. Called by the sleep timer, which clears the shared Timer3.
+void perf_skip_main_loop_sample();
+
+#endif
@@ -37,6 +37,8 @@ typedef struct {
                                      // i.e. arcs, canned cycles, and backlash compensation.
   float previous_unit_vec[N_AXIS];   // Unit vector of previous path line segment
   float previous_nominal_speed;  // Nominal speed of previous path line segment
+  uint8_t profile_update_pending; // Override change not replanned through the whole buffer yet.
+  uint8_t profile_update_index;   // Last block replanned for the override change.
 } planner_t;
 static planner_t pl;
 
@@ -96,8 +98,9 @@ static uint8_t plan_prev_block_index(uint8_t block_index)
   point) are all accelerating, they are all optimal and can not be altered by a new block added to the
   planner buffer, as this will only further increase the plan speed to chronological blocks until a maximum
   junction velocity is reached. However, if the operational conditions of the plan changes from infrequently
-  used feed holds or feedrate overrides, the stop-compute pointers will be reset and the entire plan is
-  recomputed as stated in the general guidelines.
+  used feed holds, the stop-compute pointers will be reset and the entire plan is recomputed as stated in
+  the general guidelines. Feedrate overrides replan the buffer in slices instead. See
+  plan_update_velocity_profile_slice().
 
   Planner buffer index mapping:
   - block_buffer_tail: Points to the beginning of the planner buffer. First to be executed or being executed.
@@ -132,6 +135,13 @@ static void planner_recalculate()
   // Bail. Can't do anything with one only one plan-able block.
   if (block_index == block_buffer_planned) { return; }
 
+  #ifdef ENABLE_PERFORMANCE_COUNTERS
+    // Both passes span the blocks from the planned pointer to the head of the buffer.
+    uint8_t pass_length = block_buffer_head - block_buffer_planned;
+    if (block_buffer_head < block_buffer_planned) { pass_length += BLOCK_BUFFER_SIZE; }
+    PERF_SAMPLE(perf.recalc_max, perf.recalc_avg, pass_length);
+  #endif
+
   // Reverse Pass: Coarsely maximize all possible deceleration curves back-planning from the last
   // block in buffer. Cease planning when the last optimal planned or tail pointer is reached.
   // NOTE: Forward pass will later refine and correct the reverse pass to create an optimal plan.
@@ -210,6 +220,7 @@ void plan_reset_buffer()
   block_buffer_head = 0; // Empty = tail
   next_buffer_head = 1; // plan_next_block_index(block_buffer_head)
   block_buffer_planned = 0; // = block_buffer_tail;
+  pl.profile_update_pending = false;
 }
 
 
@@ -219,6 +230,8 @@ void plan_discard_current_block()
     uint8_t block_index = plan_next_block_index( block_buffer_tail );
     // Push block_buffer_planned pointer, if encountered.
     if (block_buffer_tail == block_buffer_planned) { block_buffer_planned = block_index; }
+    // Push the override update too. Its next slice then starts from the executing block.
+    if (block_buffer_tail == pl.profile_update_index) { pl.profile_update_index = block_index; }
     block_buffer_tail = block_index;
   }
 }
@@ -281,22 +294,128 @@ static void plan_compute_profile_parameters(plan_block_t *block, float nominal_s
 }
 
 
-// Re-calculates buffered motions profile parameters upon a motion-based override change.
+// Re-calculates buffered motions profile parameters upon a motion-based override change. Replans
+// the first slice right away, so the executing block responds to the override immediately, and
+// leaves the rest of the buffer to plan_update_velocity_profile_slice().
 void plan_update_velocity_profile_parameters()
 {
-  uint8_t block_index = block_buffer_tail;
+  // Update prev nominal speed for next incoming block.
+  if (block_buffer_head == block_buffer_tail) {
+    pl.previous_nominal_speed = SOME_LARGE_VALUE;
+    pl.profile_update_pending = false;
+    return;
+  }
+  pl.previous_nominal_speed = plan_compute_profile_nominal_speed(&block_buffer[plan_prev_block_index(block_buffer_head)]);
+
+  pl.profile_update_index = block_buffer_tail;
+  pl.profile_update_pending = true;
+  plan_update_velocity_profile_slice();
+}
+
+
+/* Replans up to PLANNER_OVERRIDE_SLICE_BLOCKS blocks after the last block replanned for an override
+   change. Slices proceed from the tail of the buffer, so the blocks the segment generator is about
+   to execute are always replanned first, and the time taken per call is bounded.
+     Each slice updates the maximum entry speeds from the new nominal speeds, then runs the reverse
+   and forward passes of planner_recalculate() over the slice alone. The exit speed assumed at the
+   end of the slice is its maximum entry speed, which the full plan can only lower. The reverse pass
+   of the next slice lowers it as needed and continues into the replanned blocks only as far as they
+   can't decelerate to it, so no slice boundary is left slower than the full plan. Blocks streamed in
+   meanwhile are planned as usual. */
+void plan_update_velocity_profile_slice()
+{
+  if (!pl.profile_update_pending) { return; }
+  uint8_t block_index = pl.profile_update_index;
+  // Executing block is replanned from its current speed.
+  if (block_index == block_buffer_tail) { st_update_plan_block_parameters(); }
+  uint8_t last_index = plan_prev_block_index(block_buffer_head);
+  if ((block_buffer_head == block_buffer_tail) || (block_index == last_index)) {
+    pl.profile_update_pending = false;
+    return;
+  }
+
+  // The first block of the slice keeps its entry speed. It is either executing or was replanned
+  // as the last block of the previous slice.
+  plan_block_t *first = &block_buffer[block_index];
+  float nominal_speed = plan_compute_profile_nominal_speed(first);
+  if (block_index == block_buffer_tail) { plan_compute_profile_parameters(first, nominal_speed, SOME_LARGE_VALUE); }
+
+  // Update the maximum entry speeds of the remaining blocks in the slice.
   plan_block_t *block;
-  float nominal_speed;
-  float prev_nominal_speed = SOME_LARGE_VALUE; // Set high for first block nominal speed calculation.
-  while (block_index != block_buffer_head) {
+  float prev_nominal_speed;
+  uint8_t slice_count = PLANNER_OVERRIDE_SLICE_BLOCKS-1;
+  do {
+    block_index = plan_next_block_index(block_index);
     block = &block_buffer[block_index];
+    prev_nominal_speed = nominal_speed;
     nominal_speed = plan_compute_profile_nominal_speed(block);
     plan_compute_profile_parameters(block, nominal_speed, prev_nominal_speed);
-    prev_nominal_speed = nominal_speed;
-    block_index = plan_next_block_index(block_index);
+  } while ((--slice_count) && (block_index != last_index));
+
+  // Reverse pass from the assumed exit speed of the slice. The last block in the buffer exits at
+  // zero speed, as in planner_recalculate().
+  plan_block_t *next = block;
+  if (block_index == last_index) {
+    next->entry_speed_sqr = min(next->max_entry_speed_sqr, 2*next->acceleration*next->millimeters);
+    pl.profile_update_pending = false;
+    // Blocks that were optimal for the old speeds may be improved by the next streamed block.
+    block_buffer_planned = block_buffer_tail;
+  } else {
+    next->entry_speed_sqr = next->max_entry_speed_sqr;
+  }
+  pl.profile_update_index = block_index;
+  // Continues past the first block only while blocks replanned by earlier slices can't decelerate
+  // to the new entry speeds. The executing block is left to the segment generator.
+  float entry_speed_sqr;
+  uint8_t replanned = false;
+  block_index = plan_prev_block_index(block_index);
+  while (block_index != block_buffer_tail) {
+    block = &block_buffer[block_index];
+    if (block == first) { replanned = true; }
+    entry_speed_sqr = next->entry_speed_sqr + 2*block->acceleration*block->millimeters;
+    if (replanned) {
+      if (block->entry_speed_sqr <= entry_speed_sqr) { break; }
+      block->entry_speed_sqr = entry_speed_sqr;
+      // Exit speed of the executing block changed.
+      if (block_index == plan_next_block_index(block_buffer_tail)) { st_update_plan_block_parameters(); }
+    } else {
+      block->entry_speed_sqr = min(entry_speed_sqr, block->max_entry_speed_sqr);
+    }
+    next = block;
+    block_index = plan_prev_block_index(block_index);
   }
-  pl.previous_nominal_speed = prev_nominal_speed; // Update prev nominal speed for next incoming block.
+
+  // Forward pass from the entry speed of the first block.
+  block = first;
+  block_index = plan_next_block_index(first - block_buffer);
+  do {
+    next = &block_buffer[block_index];
+    if (block->entry_speed_sqr < next->entry_speed_sqr) {
+      entry_speed_sqr = block->entry_speed_sqr + 2*block->acceleration*block->millimeters;
+      if (entry_speed_sqr < next->entry_speed_sqr) { next->entry_speed_sqr = entry_speed_sqr; }
+    }
+    block = next;
+    block_index = plan_next_block_index(block_index);
+  } while (block != &block_buffer[pl.profile_update_index]);
+}
+
+
+#ifdef GANGED_AXES
+// Returns the axis whose motion a ganged motor copies, or the axis itself when it is not ganged.
+static uint8_t plan_get_gang_master(uint8_t idx)
+{
+  #ifdef AXIS_4_MASTER
+    if (idx == AXIS_4) { return(AXIS_4_MASTER); }
+  #endif
+  #ifdef AXIS_5_MASTER
+    if (idx == AXIS_5) { return(AXIS_5_MASTER); }
+  #endif
+  #ifdef AXIS_6_MASTER
+    if (idx == AXIS_6) { return(AXIS_6_MASTER); }
+  #endif
+  return(idx);
 }
+#endif
 
 
 /* Add a new linear movement to the buffer. target[N_AXIS] is the signed, absolute target position
@@ -321,6 +440,10 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
   block->condition = pl_data->condition;
   block->spindle_speed = pl_data->spindle_speed;
   block->line_number = pl_data->line_number;
+  #ifdef LASER_RASTER
+    block->raster_start = pl_data->raster_start;
+    block->raster_count = pl_data->raster_count;
+  #endif
 
   // Compute and store initial move distance data.
   int32_t target_steps[N_AXIS], position_steps[N_AXIS];
@@ -358,6 +481,13 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
     // Calculate target position in absolute steps, number of steps for each axis, and determine max step events.
     // Also, compute individual axes distance for move and prep unit vector calculations.
     // NOTE: Computes true distance from converted step values.
+    #ifdef INDEXER_AXIS
+      if (idx == INDEXER_AXIS) { // Moved by the indexer only.
+        target_steps[idx] = position_steps[idx];
+        unit_vec[idx] = 0.0;
+        continue;
+      }
+    #endif
     #ifdef COREXY
       if ( !(idx == A_MOTOR) && !(idx == B_MOTOR) ) {
         target_steps[idx] = lround(target[idx]*settings.steps_per_mm[idx]);
@@ -372,6 +502,18 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
         delta_mm = (target_steps[idx] - position_steps[idx])/settings.steps_per_mm[idx];
       }
     #else
+      #ifdef GANGED_AXES
+        // A ganged motor copies the steps and direction of its master, which is computed first, and
+        // is left out of the unit vector. During homing, the motors move apart to square the axis.
+        uint8_t master_idx = plan_get_gang_master(idx);
+        if ((master_idx != idx) && (sys.state != STATE_HOMING)) {
+          target_steps[idx] = position_steps[idx]+(target_steps[master_idx]-position_steps[master_idx]);
+          block->steps[idx] = block->steps[master_idx];
+          if (block->direction_bits[master_idx]) { block->direction_bits[idx] = get_direction_pin_mask(idx); }
+          unit_vec[idx] = 0.0;
+          continue;
+        }
+      #endif
       target_steps[idx] = lround(target[idx]*settings.steps_per_mm[idx]);
       block->steps[idx] = labs(target_steps[idx]-position_steps[idx]);
       block->step_event_count = max(block->step_event_count, block->steps[idx]);
@@ -405,6 +547,16 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
     if (block->condition & PL_COND_FLAG_INVERSE_TIME) { block->programmed_rate *= block->millimeters; }
   }
 
+  #ifdef MINIMUM_BLOCK_TIME
+    // Limit the rate, so the block lasts long enough to plan and prepare the next one. Feed motions
+    // are limited after the feed override by the axis-limited rate, so the cap is stored there.
+    float block_time_rate = block->millimeters*(60000.0/MINIMUM_BLOCK_TIME);
+    if (!(block->condition & PL_COND_FLAG_SYSTEM_MOTION)) {
+      if (block->rapid_rate > block_time_rate) { block->rapid_rate = block_time_rate; }
+      if (block->condition & PL_COND_FLAG_RAPID_MOTION) { block->programmed_rate = block->rapid_rate; }
+    }
+  #endif
+
   // TODO: Need to check this method handling zero junction speeds when starting from rest.
   if ((block_buffer_head == block_buffer_tail) || (block->condition & PL_COND_FLAG_SYSTEM_MOTION)) {
 
@@ -454,9 +606,24 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
       } else {
         convert_delta_vector_to_unit_vector(junction_unit_vec);
         float junction_acceleration = limit_value_by_axis_maximum(settings.acceleration, junction_unit_vec);
+        // Rotary axes deviate in degrees by their own setting. The deviation along the junction is
+        // limited, so that neither the linear nor the rotary axes, as groups, deviate beyond theirs.
+        // Junctions of linear axes only are computed exactly as before.
+        float junction_deviation = settings.junction_deviation;
+        uint8_t rotary_mask = (axis_A_mask | axis_B_mask | axis_C_mask);
+        if (rotary_mask) {
+          float rotary_sqr = 0.0;
+          for (idx=0; idx<N_AXIS; idx++) {
+            if (rotary_mask & bit(idx)) { rotary_sqr += junction_unit_vec[idx]*junction_unit_vec[idx]; }
+          }
+          if (rotary_sqr > 0.0) {
+            junction_deviation = settings.rotary_junction_deviation/sqrt(rotary_sqr);
+            if (rotary_sqr < 1.0) { junction_deviation = min(junction_deviation, settings.junction_deviation/sqrt(1.0-rotary_sqr)); }
+          }
+        }
         float sin_theta_d2 = sqrt(0.5*(1.0-junction_cos_theta)); // Trig half angle identity. Always positive.
         block->max_junction_speed_sqr = max( MINIMUM_JUNCTION_SPEED*MINIMUM_JUNCTION_SPEED,
-                       (junction_acceleration * settings.junction_deviation * sin_theta_d2)/(1.0-sin_theta_d2) );
+                       (junction_acceleration * junction_deviation * sin_theta_d2)/(1.0-sin_theta_d2) );
       }
     }
   }
@@ -464,6 +631,9 @@ uint8_t plan_buffer_line(float *target, plan_line_data_t *pl_data)
   // Block system motion from updating this data to ensure next g-code motion is computed correctly.
   if (!(block->condition & PL_COND_FLAG_SYSTEM_MOTION)) {
     float nominal_speed = plan_compute_profile_nominal_speed(block);
+    #if defined(MINIMUM_BLOCK_TIME) && defined(ENABLE_PERFORMANCE_COUNTERS)
+      if (nominal_speed >= block_time_rate) { perf.block_time_limited++; }
+    #endif
     plan_compute_profile_parameters(block, nominal_speed, pl.previous_nominal_speed);
     pl.previous_nominal_speed = nominal_speed;
 
@@ -504,6 +674,12 @@ void plan_sync_position()
 }
 
 
+void plan_shift_position(uint8_t axis_idx, int32_t steps)
+{
+  pl.position[axis_idx] -= steps;
+}
+
+
 // Returns the number of available blocks are in the planner buffer.
 uint8_t plan_get_block_buffer_available()
 {
@@ -525,6 +701,9 @@ uint8_t plan_get_block_buffer_count()
 // Called after a steppers have come to a complete stop for a feed hold and the cycle is stopped.
 void plan_cycle_reinitialize()
 {
+  // Finish any override update first, so the whole buffer is planned for the current overrides.
+  while (pl.profile_update_pending) { plan_update_velocity_profile_slice(); }
+
   // Re-plan from a complete stop. Reset planner entry speeds and buffer planned pointer.
   st_update_plan_block_parameters();
   block_buffer_planned = block_buffer_tail;
@@ -28,6 +28,11 @@
   #define BLOCK_BUFFER_SIZE 36
 #endif
 
+// The number of blocks replanned at a time after a feed or rapid override change
+#ifndef PLANNER_OVERRIDE_SLICE_BLOCKS
+  #define PLANNER_OVERRIDE_SLICE_BLOCKS 6
+#endif
+
 // Returned status message from planner.
 #define PLAN_OK true
 #define PLAN_EMPTY_BLOCK false
@@ -77,6 +82,11 @@ typedef struct {
 
   // Stored spindle speed data used by spindle overrides and resuming methods.
   float spindle_speed;    // Block spindle speed. Copied from pl_line_data.
+
+  #ifdef LASER_RASTER
+    uint16_t raster_start; // Raster buffer index of the first pixel. Copied from pl_line_data.
+    uint8_t raster_count;  // Pixels along the block. Zero, if not a raster block.
+  #endif
 } plan_block_t;
 
 
@@ -86,6 +96,10 @@ typedef struct {
   float spindle_speed;      // Desired spindle speed through line motion.
   int32_t line_number;    // Desired line number to report when executing.
   uint8_t condition;        // Bitflag variable to indicate planner conditions. See defines above.
+  #ifdef LASER_RASTER
+    uint16_t raster_start;  // Raster buffer index of the first pixel of the line.
+    uint8_t raster_count;   // Pixels along the line.
+  #endif
 } plan_line_data_t;
 
 
@@ -117,12 +131,20 @@ float plan_get_exec_block_exit_speed_sqr();
 // Called by main program during planner calculations and step segment buffer during initialization.
 float plan_compute_profile_nominal_speed(plan_block_t *block);
 
-// Re-calculates buffered motions profile parameters upon a motion-based override change.
+// Re-calculates buffered motions profile parameters upon a motion-based override change. Only
+// replans the blocks about to be executed. The rest is left to plan_update_velocity_profile_slice().
 void plan_update_velocity_profile_parameters();
 
+// Replans the next slice of blocks after an override change, if any are left. Called by the step
+// segment buffer, so the blocks are replanned before it executes them.
+void plan_update_velocity_profile_slice();
+
 // Reset the planner position vector (in steps)
 void plan_sync_position();
 
+// Moves the origin of an axis planner position by a number of steps. Used to wrap rotary axes.
+void plan_shift_position(uint8_t axis_idx, int32_t steps);
+
 // Reinitialize plan with a partially completed block
 void plan_cycle_reinitialize();
 
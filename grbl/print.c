@@ -22,6 +22,20 @@
 #include "grbl.h"
 
 
+// Decimal digit pairs "00" to "99". Allows integers to be converted two digits per division.
+static const char print_digit_pairs[200] PROGMEM =
+  "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+  "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+// Fixed-point scale factors converting axis steps into reported coordinate units, which are
+// 10^-N_DECIMAL_COORDVALUE_MM mm or 10^-N_DECIMAL_COORDVALUE_INCH inches. A coordinate is given by
+// (steps*scale) >> shift, where the shift is chosen per axis to keep the scale at 31 bits. A zero
+// scale marks an axis with steps/mm out of the fixed-point range, which is converted with floats.
+static uint32_t print_coord_scale[N_AXIS];
+static uint8_t print_coord_shift[N_AXIS];
+static float print_coord_units_per_mm;
+
+
 void printString(const char *s)
 {
   while (*s)
@@ -29,12 +43,20 @@ void printString(const char *s)
 }
 
 
-// Print a string stored in PGM-memory
+// Print a string stored in PGM-memory. Copies as much as the TX buffer has room for with each
+// reservation, rather than waiting for room for the whole string.
 void printPgmString(const char *s)
 {
-  char c;
-  while ((c = pgm_read_byte_near(s++)))
-    serial_write(c);
+  char c = pgm_read_byte_near(s++);
+  while (c) {
+    if (!serial_write_reserve(1)) { return; }
+    uint8_t n = serial_get_tx_buffer_available();
+    do {
+      serial_write_reserved(c);
+      c = pgm_read_byte_near(s++);
+    } while (c && --n);
+    serial_write_commit();
+  }
 }
 
 
@@ -94,33 +116,69 @@ void print_uint8_base2_ndigit(uint8_t n, uint8_t digits) {
 }
 
 
-void print_uint32_base10(uint32_t n)
+// Converts an unsigned integer into decimal digits, which are written backwards ending at the
+// given buffer position and zero-padded to at least min_digits. Returns the first digit.
+static char *print_uint32_to_buffer(char *end, uint32_t n, uint8_t min_digits)
 {
-  if (n == 0) {
-    serial_write('0');
-    return;
+  char *p = end;
+  uint8_t r;
+  while (n >= 100) {
+    uint32_t q = n/100;
+    r = n-q*100;
+    *--p = pgm_read_byte(&print_digit_pairs[2*r+1]);
+    *--p = pgm_read_byte(&print_digit_pairs[2*r]);
+    n = q;
   }
+  r = n;
+  *--p = pgm_read_byte(&print_digit_pairs[2*r+1]);
+  if (r >= 10) { *--p = pgm_read_byte(&print_digit_pairs[2*r]); }
+  while ((uint8_t)(end-p) < min_digits) { *--p = '0'; }
+  return(p);
+}
 
-  unsigned char buf[10];
-  uint8_t i = 0;
 
-  while (n > 0) {
-    buf[i++] = n % 10;
-    n /= 10;
+// Prints an unsigned integer scaled by 10^decimal_places as a decimal number. The complete
+// string is built on the stack and copied into the serial write buffer in one pass.
+static void print_decimal(uint32_t n, uint8_t decimal_places, uint8_t negative)
+{
+  char buf[14]; // Sign, 10 digits, decimal point and a leading zero.
+  char *end = buf+sizeof(buf);
+  char *p = print_uint32_to_buffer(end, n, decimal_places+1);
+  if (decimal_places) {
+    // Shift integer digits left to make room for the decimal point.
+    uint8_t n_int = (end-p)-decimal_places;
+    memmove(p-1, p, n_int);
+    p--;
+    p[n_int] = '.';
   }
+  if (negative) { *--p = '-'; }
+  serial_write_buffer((uint8_t*)p, end-p);
+}
 
-  for (; i > 0; i--)
-    serial_write('0' + buf[i-1]);
+
+void print_uint32_base10(uint32_t n)
+{
+  print_decimal(n, 0, false);
 }
 
 
 void printInteger(long n)
 {
   if (n < 0) {
-    serial_write('-');
-    print_uint32_base10(-n);
+    print_decimal(-n, 0, true);
+  } else {
+    print_decimal(n, 0, false);
+  }
+}
+
+
+// Prints a fixed-point integer, holding a value scaled by 10^decimal_places, as a decimal number.
+void printFixed(int32_t n, uint8_t decimal_places)
+{
+  if (n < 0) {
+    print_decimal(-n, decimal_places, true);
   } else {
-    print_uint32_base10(n);
+    print_decimal(n, decimal_places, false);
   }
 }
 
@@ -132,8 +190,9 @@ void printInteger(long n)
 // techniques are actually just slightly slower. Found this out the hard way.
 void printFloat(float n, uint8_t decimal_places)
 {
+  uint8_t negative = false;
   if (n < 0) {
-    serial_write('-');
+    negative = true;
     n = -n;
   }
 
@@ -145,26 +204,7 @@ void printFloat(float n, uint8_t decimal_places)
   if (decimals) { n *= 10; }
   n += 0.5; // Add rounding factor. Ensures carryover through entire value.
 
-  // Generate digits backwards and store in string.
-  unsigned char buf[13];
-  uint8_t i = 0;
-  uint32_t a = (long)n;
-  while(a > 0) {
-    buf[i++] = (a % 10) + '0'; // Get digit
-    a /= 10;
-  }
-  while (i < decimal_places) {
-     buf[i++] = '0'; // Fill in zeros to decimal point for (n < 1)
-  }
-  if (i == decimal_places) { // Fill in leading zero, if needed.
-    buf[i++] = '0';
-  }
-
-  // Print the generated string.
-  for (; i > 0; i--) {
-    if (i == decimal_places) { serial_write('.'); } // Insert decimal point in right place.
-    serial_write(buf[i-1]);
-  }
+  print_decimal((uint32_t)n, decimal_places, negative);
 }
 
 
@@ -188,6 +228,86 @@ void printFloat_RateValue(float n) {
   }
 }
 
+// Recomputes the fixed-point coordinate scale factors. Must be called whenever the axis steps/mm
+// or the report inches setting changes.
+// NOTE: The scale is derived by binary long division from the exact binary value of the steps/mm
+// float, so it carries a full 31 bits of precision instead of the 24 bits of a float. Only 32-bit
+// arithmetic is used, which keeps the 64-bit division routines out of the firmware.
+void print_update_coord_scale()
+{
+  uint8_t idx;
+  uint32_t numerator = 1; // Coordinate units per mm as the ratio numerator/denominator.
+  uint16_t denominator = 1;
+  if (bit_istrue(settings.flags,BITFLAG_REPORT_INCHES)) {
+    for (idx=0; idx<N_DECIMAL_COORDVALUE_INCH+1; idx++) { numerator *= 10; }
+    denominator = 254; // 10/254 inch per mm
+  } else {
+    for (idx=0; idx<N_DECIMAL_COORDVALUE_MM; idx++) { numerator *= 10; }
+  }
+  print_coord_units_per_mm = (float)numerator/denominator;
+
+  for (idx=0; idx<N_AXIS; idx++) {
+    print_coord_scale[idx] = 0; // Reported through floats, unless a scale is found below.
+    if (!(settings.steps_per_mm[idx] > 0.0)) { continue; }
+    // Split steps/mm into a 24-bit integer mantissa and a binary exponent. Times the denominator,
+    // the divisor still fits 32 bits and always exceeds the numerator.
+    int exponent;
+    uint32_t divisor = (uint32_t)(frexp(settings.steps_per_mm[idx],&exponent)*16777216.0)*denominator;
+    int8_t shift = exponent-24;
+    // Divide until the quotient scale = numerator*2^shift/divisor is normalized to [2^30,2^31).
+    // The remainder stays below the divisor, so a bit carried out when doubling it means a
+    // quotient bit of one.
+    uint32_t scale = 0;
+    uint32_t remainder = numerator;
+    uint8_t carry;
+    while (!(scale & 0x40000000)) {
+      carry = (remainder & 0x80000000) != 0;
+      remainder <<= 1;
+      scale <<= 1;
+      if (carry || (remainder >= divisor)) {
+        remainder -= divisor;
+        scale |= 1;
+      }
+      shift++;
+    }
+    if (shift < 0) { continue; } // Unrealistically small steps/mm. Out of the fixed-point range.
+    carry = (remainder & 0x80000000) != 0;
+    if (carry || ((remainder << 1) >= divisor)) { scale++; } // Round to nearest.
+    print_coord_scale[idx] = scale;
+    print_coord_shift[idx] = shift;
+  }
+}
+
+
+// Converts axis steps into reported coordinate units, rounded to nearest, without any floats.
+// Axes without a fixed-point scale fall back to float arithmetic.
+int32_t print_steps_to_coord_units(int32_t steps, uint8_t idx)
+{
+  uint32_t scale = print_coord_scale[idx];
+  if (scale == 0) { return(lround((steps/settings.steps_per_mm[idx])*print_coord_units_per_mm)); }
+  uint8_t shift = print_coord_shift[idx];
+  int64_t units = (int64_t)steps*scale;
+  if (shift) { units += ((int64_t)1 << (shift-1)); }
+  return((int32_t)(units >> shift));
+}
+
+
+// Converts a position in mm into reported coordinate units.
+int32_t print_mm_to_coord_units(float mm)
+{
+  return(lround(mm*print_coord_units_per_mm));
+}
+
+
+// Prints a coordinate given in the reported coordinate units.
+void printFixed_CoordValue(int32_t n) {
+  if (bit_istrue(settings.flags,BITFLAG_REPORT_INCHES)) {
+    printFixed(n,N_DECIMAL_COORDVALUE_INCH);
+  } else {
+    printFixed(n,N_DECIMAL_COORDVALUE_MM);
+  }
+}
+
 // Debug tool to print free memory in bytes at the called point.
 // NOTE: Keep commented unless using. Part of this function always gets compiled in.
 // void printFreeMemory()
@@ -39,12 +39,22 @@ void print_uint8_base2_ndigit(uint8_t n, uint8_t digits);
 
 void printFloat(float n, uint8_t decimal_places);
 
+// Prints a fixed-point integer, holding a value scaled by 10^decimal_places.
+void printFixed(int32_t n, uint8_t decimal_places);
+
 // Floating value printing handlers for special variables types used in Grbl.
 //  - CoordValue: Handles all position or coordinate values in inches or mm reporting.
 //  - RateValue: Handles feed rate and current velocity in inches or mm reporting.
 void printFloat_CoordValue(float n);
 void printFloat_RateValue(float n);
 
+// Fixed-point position reporting. Converts axis steps into coordinate units of the reported
+// resolution, i.e. 0.001mm or 0.0001in, through precomputed per-axis scale factors.
+void print_update_coord_scale();
+int32_t print_steps_to_coord_units(int32_t steps, uint8_t idx);
+int32_t print_mm_to_coord_units(float mm);
+void printFixed_CoordValue(int32_t n);
+
 // Debug tool to print free memory in bytes at the called point. Not used otherwise.
 void printFreeMemory();
 
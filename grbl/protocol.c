@@ -32,6 +32,25 @@ static char line[LINE_BUFFER_SIZE]; // Line to be executed. Zero-terminated.
 static void protocol_exec_rt_suspend();
 
 
+// Directs and executes one line of formatted input, and reports status of execution.
+static void protocol_execute_line(char *block)
+{
+  if (block[0] == 0) {
+    // Empty or comment line. For syncing purposes.
+    report_status_message(STATUS_OK);
+  } else if (block[0] == '$') {
+    // Grbl '$' system command
+    report_status_message(system_execute_line(block));
+  } else if (sys.state & (STATE_ALARM | STATE_JOG)) {
+    // Everything else is gcode. Block if in alarm or jog mode.
+    report_status_message(STATUS_SYSTEM_GC_LOCK);
+  } else {
+    // Parse and execute g-code block.
+    report_status_message(gc_execute_line(block));
+  }
+}
+
+
 /*
   GRBL PRIMARY LOOP:
 */
@@ -68,88 +87,104 @@ void protocol_main_loop()
   // This is also where Grbl idles while waiting for something to do.
   // ---------------------------------------------------------------------------------
 
-  uint8_t line_flags = 0;
-  uint8_t char_counter = 0;
-  uint8_t c;
+  #ifdef ENABLE_RX_LINE_ASSEMBLY
+    char *block;
+  #else
+    uint8_t line_flags = 0;
+    uint8_t char_counter = 0;
+    uint8_t c;
+  #endif
   for (;;) {
 
-    // Process one line of incoming serial data, as the data becomes available. Performs an
-    // initial filtering by removing spaces and comments and capitalizing all letters.
-    while((c = serial_read()) != SERIAL_NO_DATA) {
-      if ((c == '\n') || (c == '\r')) { // End of line reached
+    #ifdef ENABLE_RX_LINE_ASSEMBLY
+      // Execute complete lines as they become available. The RX interrupt has already filtered
+      // them, so they are executed directly out of the serial read buffer. A long report started
+      // by a '$' command is finished first.
+      while (!report_continue() && (block = serial_get_line(line)) != NULL) {
 
         protocol_execute_realtime(); // Runtime command check point.
         if (sys.abort) { return; } // Bail to calling function upon system abort
 
-        line[char_counter] = 0; // Set string termination character.
-        #ifdef REPORT_ECHO_LINE_RECEIVED
-          report_echo_line_received(line);
-        #endif
-
-        // Direct and execute one line of formatted input, and report status of execution.
-        if (line_flags & LINE_FLAG_OVERFLOW) {
+        if (block[0] == SERIAL_LINE_OVERFLOW) {
           // Report line overflow error.
           report_status_message(STATUS_OVERFLOW);
-        } else if (line[0] == 0) {
-          // Empty or comment line. For syncing purposes.
-          report_status_message(STATUS_OK);
-        } else if (line[0] == '$') {
-          // Grbl '$' system command
-          report_status_message(system_execute_line(line));
-        } else if (sys.state & (STATE_ALARM | STATE_JOG)) {
-          // Everything else is gcode. Block if in alarm or jog mode.
-          report_status_message(STATUS_SYSTEM_GC_LOCK);
         } else {
-          // Parse and execute g-code block.
-          report_status_message(gc_execute_line(line));
+          #ifdef REPORT_ECHO_LINE_RECEIVED
+            report_echo_line_received(block);
+          #endif
+          protocol_execute_line(block);
         }
+        serial_release_line();
+      }
+    #else
+      // Process one line of incoming serial data, as the data becomes available. Performs an
+      // initial filtering by removing spaces and comments and capitalizing all letters. A long
+      // report started by a '$' command is finished first.
+      while(!report_continue() && (c = serial_read()) != SERIAL_NO_DATA) {
+        if ((c == '\n') || (c == '\r')) { // End of line reached
+
+          protocol_execute_realtime(); // Runtime command check point.
+          if (sys.abort) { return; } // Bail to calling function upon system abort
+
+          line[char_counter] = 0; // Set string termination character.
+          #ifdef REPORT_ECHO_LINE_RECEIVED
+            report_echo_line_received(line);
+          #endif
 
-        // Reset tracking data for next line.
-        line_flags = 0;
-        char_counter = 0;
+          if (line_flags & LINE_FLAG_OVERFLOW) {
+            // Report line overflow error.
+            report_status_message(STATUS_OVERFLOW);
+          } else {
+            protocol_execute_line(line);
+          }
 
-      } else {
+          // Reset tracking data for next line.
+          line_flags = 0;
+          char_counter = 0;
 
-        if (line_flags) {
-          // Throw away all (except EOL) comment characters and overflow characters.
-          if (c == ')') {
-            // End of '()' comment. Resume line allowed.
-            if (line_flags & LINE_FLAG_COMMENT_PARENTHESES) { line_flags &= ~(LINE_FLAG_COMMENT_PARENTHESES); }
-          }
         } else {
-          if (c <= ' ') {
-            // Throw away whitepace and control characters
-          } else if (c == '/') {
-            // Block delete NOT SUPPORTED. Ignore character.
-            // NOTE: If supported, would simply need to check the system if block delete is enabled.
-          } else if (c == '(') {
-            // Enable comments flag and ignore all characters until ')' or EOL.
-            // NOTE: This doesn't follow the NIST definition exactly, but is good enough for now.
-            // In the future, we could simply remove the items within the comments, but retain the
-            // comment control characters, so that the g-code parser can error-check it.
-            line_flags |= LINE_FLAG_COMMENT_PARENTHESES;
-          } else if (c == ';') {
-            // NOTE: ';' comment to EOL is a LinuxCNC definition. Not NIST.
-            line_flags |= LINE_FLAG_COMMENT_SEMICOLON;
-          // TODO: Install '%' feature
-          // } else if (c == '%') {
-            // Program start-end percent sign NOT SUPPORTED.
-            // NOTE: This maybe installed to tell Grbl when a program is running vs manual input,
-            // where, during a program, the system auto-cycle start will continue to execute
-            // everything until the next '%' sign. This will help fix resuming issues with certain
-            // functions that empty the planner buffer to execute its task on-time.
-          } else if (char_counter >= (LINE_BUFFER_SIZE-1)) {
-            // Detect line buffer overflow and set flag.
-            line_flags |= LINE_FLAG_OVERFLOW;
-          } else if (c >= 'a' && c <= 'z') { // Upcase lowercase
-            line[char_counter++] = c-'a'+'A';
+
+          if (line_flags) {
+            // Throw away all (except EOL) comment characters and overflow characters.
+            if (c == ')') {
+              // End of '()' comment. Resume line allowed.
+              if (line_flags & LINE_FLAG_COMMENT_PARENTHESES) { line_flags &= ~(LINE_FLAG_COMMENT_PARENTHESES); }
+            }
           } else {
-            line[char_counter++] = c;
+            if (c <= ' ') {
+              // Throw away whitepace and control characters
+            } else if (c == '/') {
+              // Block delete NOT SUPPORTED. Ignore character.
+              // NOTE: If supported, would simply need to check the system if block delete is enabled.
+            } else if (c == '(') {
+              // Enable comments flag and ignore all characters until ')' or EOL.
+              // NOTE: This doesn't follow the NIST definition exactly, but is good enough for now.
+              // In the future, we could simply remove the items within the comments, but retain the
+              // comment control characters, so that the g-code parser can error-check it.
+              line_flags |= LINE_FLAG_COMMENT_PARENTHESES;
+            } else if (c == ';') {
+              // NOTE: ';' comment to EOL is a LinuxCNC definition. Not NIST.
+              line_flags |= LINE_FLAG_COMMENT_SEMICOLON;
+            // TODO: Install '%' feature
+            // } else if (c == '%') {
+              // Program start-end percent sign NOT SUPPORTED.
+              // NOTE: This maybe installed to tell Grbl when a program is running vs manual input,
+              // where, during a program, the system auto-cycle start will continue to execute
+              // everything until the next '%' sign. This will help fix resuming issues with certain
+              // functions that empty the planner buffer to execute its task on-time.
+            } else if (char_counter >= (LINE_BUFFER_SIZE-1)) {
+              // Detect line buffer overflow and set flag.
+              line_flags |= LINE_FLAG_OVERFLOW;
+            } else if (c >= 'a' && c <= 'z') { // Upcase lowercase
+              line[char_counter++] = c-'a'+'A';
+            } else {
+              line[char_counter++] = c;
+            }
           }
-        }
 
+        }
       }
-    }
+    #endif
 
     // If there are no more characters in the serial read buffer to be processed and executed,
     // this indicates that g-code streaming has either filled the planner buffer or has
@@ -163,6 +198,10 @@ void protocol_main_loop()
       // Check for sleep conditions and execute auto-park, if timeout duration elapses.
       sleep_check();
     #endif
+
+    #ifdef ENABLE_PERFORMANCE_COUNTERS
+      perf_sample_main_loop();
+    #endif
   }
 
   return; /* Never reached */
@@ -387,6 +426,9 @@ void protocol_exec_rt_system()
       } else {
         // Motion complete. Includes CYCLE/JOG/HOMING states and jog cancel/motion cancel/soft limit events.
         // NOTE: Motion and jog cancel both immediately return to idle after the hold completes.
+        #ifdef ENABLE_JOB_CHECKPOINT
+          if ((sys.state == STATE_CYCLE) && (plan_get_current_block() == NULL)) { checkpoint_cycle_complete(); }
+        #endif
         if (sys.suspend & SUSPEND_JOG_CANCEL) {   // For jog cancel, flush buffers and sync positions.
           sys.step_control = STEP_CONTROL_NORMAL_OP;
           plan_reset();
@@ -431,7 +473,6 @@ void protocol_exec_rt_system()
       sys.r_override = new_r_override;
       sys.report_ovr_counter = 0; // Set to report change immediately
       plan_update_velocity_profile_parameters();
-      plan_cycle_reinitialize();
     }
   }
 
@@ -452,6 +493,7 @@ void protocol_exec_rt_system()
     if (last_s_override != sys.spindle_speed_ovr) {
       bit_true(sys.step_control, STEP_CONTROL_UPDATE_SPINDLE_PWM);
       sys.spindle_speed_ovr = last_s_override;
+      spindle_update_pwm_override();
       sys.report_ovr_counter = 0; // Set to report change immediately
     }
 
@@ -494,6 +536,9 @@ void protocol_exec_rt_system()
   if (sys.state & (STATE_CYCLE | STATE_HOLD | STATE_SAFETY_DOOR | STATE_HOMING | STATE_SLEEP| STATE_JOG)) {
     st_prep_buffer();
   }
+  #ifdef MOTOR_CURRENT_PROFILES
+    else { current_update(); } // Drop to the idle current, once the last motion has finished.
+  #endif
 
 }
 
@@ -665,7 +710,11 @@ static void protocol_exec_rt_suspend()
                   bit_true(sys.step_control, STEP_CONTROL_UPDATE_SPINDLE_PWM);
                 } else {
                   spindle_set_state((restore_condition & (PL_COND_FLAG_SPINDLE_CW | PL_COND_FLAG_SPINDLE_CCW)), restore_spindle_speed);
-                  delay_sec(SAFETY_DOOR_SPINDLE_DELAY, DELAY_MODE_SYS_SUSPEND);
+                  #ifdef SPINDLE_AT_SPEED
+                    spindle_wait_at_speed(DELAY_MODE_SYS_SUSPEND);
+                  #else
+                    delay_sec(SAFETY_DOOR_SPINDLE_DELAY, DELAY_MODE_SYS_SUSPEND);
+                  #endif
                 }
               }
             }
@@ -730,6 +779,9 @@ static void protocol_exec_rt_suspend()
                 bit_true(sys.step_control, STEP_CONTROL_UPDATE_SPINDLE_PWM);
               } else {
                 spindle_set_state((restore_condition & (PL_COND_FLAG_SPINDLE_CW | PL_COND_FLAG_SPINDLE_CCW)), restore_spindle_speed);
+                #ifdef SPINDLE_AT_SPEED
+                  spindle_wait_at_speed(DELAY_MODE_SYS_SUSPEND);
+                #endif
               }
             }
             if (sys.spindle_stop_ovr & SPINDLE_STOP_OVR_RESTORE_CYCLE) {
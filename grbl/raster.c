@@ -0,0 +1,97 @@
+/*
+  raster.c - laser raster pixel buffer for per-step power modulation
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  A raster line carries a scanline of laser power values, one byte per pixel, in a 'D' word of hex
+  digits at the end of a G1 block. The pixels are spaced evenly along the line. They are copied into
+  a ring buffer, and the planner block only keeps their position and number. The stepper ISR then
+  steps through them with an extra Bresenham counter alongside the axes and writes each pixel's power
+  to the spindle PWM as the tool reaches it, so a whole scanline runs as a single block.
+*/
+
+#include "grbl.h"
+
+#ifdef LASER_RASTER
+
+uint8_t raster_buffer[RASTER_BUFFER_SIZE];
+volatile uint16_t raster_buffer_tail;
+static uint16_t raster_buffer_head;
+
+
+static uint8_t raster_hex_value(char c)
+{
+  if ((c >= '0') && (c <= '9')) { return(c-'0'); }
+  if ((c >= 'A') && (c <= 'F')) { return(c-'A'+10); }
+  return(0xff);
+}
+
+
+static uint16_t raster_buffer_available()
+{
+  uint8_t sreg = SREG;
+  cli();
+  uint16_t tail = raster_buffer_tail;
+  SREG = sreg;
+  if (tail > raster_buffer_head) { return(tail-raster_buffer_head-1); }
+  return(RASTER_BUFFER_SIZE-1-(raster_buffer_head-tail));
+}
+
+
+void raster_reset()
+{
+  raster_buffer_head = 0;
+  raster_buffer_tail = 0;
+}
+
+
+uint8_t raster_check_pixels(char *line, uint8_t *char_counter)
+{
+  uint8_t pixel_count = 0;
+  while (line[*char_counter] != 0) {
+    if ((raster_hex_value(line[*char_counter]) == 0xff) || (raster_hex_value(line[*char_counter+1]) == 0xff)) {
+      return(0); // Not a hex digit, or an odd number of them.
+    }
+    *char_counter += 2;
+    pixel_count++;
+  }
+  return(pixel_count);
+}
+
+
+void raster_queue_pixels(char *hex, uint8_t pixel_count, plan_line_data_t *pl_data)
+{
+  // If in check gcode mode, don't queue anything, like the line motion.
+  if (sys.state == STATE_CHECK_MODE) { return; }
+
+  // Remain in this loop until the blocks ahead have released enough pixels.
+  while (raster_buffer_available() < pixel_count) {
+    protocol_execute_realtime();
+    if (sys.abort) { return; }
+    protocol_auto_cycle_start();
+  }
+
+  pl_data->raster_start = raster_buffer_head;
+  pl_data->raster_count = pixel_count;
+  while (pixel_count--) {
+    raster_buffer[raster_buffer_head] = (raster_hex_value(hex[0]) << 4) | raster_hex_value(hex[1]);
+    hex += 2;
+    if (++raster_buffer_head == RASTER_BUFFER_SIZE) { raster_buffer_head = 0; }
+  }
+}
+
+#endif
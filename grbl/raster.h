@@ -0,0 +1,48 @@
+/*
+  raster.h - laser raster pixel buffer for per-step power modulation
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef raster_h
+#define raster_h
+
+#include "grbl.h"
+
+
+// Bytes of the pixel ring buffer shared by the raster blocks in the planner. A full line holds up
+// to (LINE_BUFFER_SIZE-1)/2 pixels. G1 waits for room when the buffer is full.
+#ifndef RASTER_BUFFER_SIZE
+  #define RASTER_BUFFER_SIZE 512
+#endif
+
+// Pixel ring buffer. Written by the main program at the head, read by the stepper ISR, which moves
+// the tail up to the pixel it outputs.
+extern uint8_t raster_buffer[RASTER_BUFFER_SIZE];
+extern volatile uint16_t raster_buffer_tail;
+
+
+// Empties the pixel buffer. Called upon a system abort.
+void raster_reset();
+
+// Checks the hex pixel data of a 'D' word, which runs to the end of the line, and moves the line
+// index past it. Returns the number of pixels, or zero, if the data is malformed.
+uint8_t raster_check_pixels(char *line, uint8_t *char_counter);
+
+// Copies the checked pixels of a line into the buffer and attaches them to the planner data of the
+// line motion. Waits for room in the buffer.
+void raster_queue_pixels(char *hex, uint8_t pixel_count, plan_line_data_t *pl_data);
+
+#endif
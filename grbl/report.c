@@ -29,6 +29,13 @@
 
 #include "grbl.h"
 
+#define REPORT_STATUS_NONE 0xff // No status message held back.
+
+// Long report printed a line at a time from the main loop. See report_start().
+static uint8_t report_pending = REPORT_NONE;
+static uint8_t report_pending_line;   // Next line of the pending report.
+static uint8_t report_pending_status = REPORT_STATUS_NONE; // Response to the requesting line.
+
 
 // Internal report utilities to reduce flash with repetitive tasks turned into functions.
 void report_util_setting_prefix(uint8_t n) { serial_write('$'); print_uint8_base10(n); serial_write('='); }
@@ -44,6 +51,36 @@ static void report_util_axis_values(float *axis_value) {
     if (idx < (N_AXIS-1)) { serial_write(','); }
   }
 }
+// NOTE: Positions of wrapped rotary axes are printed within one turn, [0,360) degrees.
+static void report_util_axis_coord_values(int32_t *axis_value) {
+  uint8_t idx;
+  for (idx=0; idx<N_AXIS; idx++) {
+    if (bit_istrue(settings.rotary_wrap_mask,bit(idx))) {
+      int32_t turn = print_mm_to_coord_units(360.0);
+      axis_value[idx] %= turn;
+      if (axis_value[idx] < 0) { axis_value[idx] += turn; }
+    }
+    printFixed_CoordValue(axis_value[idx]);
+    if (idx < (N_AXIS-1)) { serial_write(','); }
+  }
+}
+// Converts machine steps into reported coordinate units. Fixed-point version of
+// system_convert_array_steps_to_mpos().
+static void report_util_steps_to_coord_values(int32_t *axis_value, int32_t *steps) {
+  uint8_t idx;
+  for (idx=0; idx<N_AXIS; idx++) {
+    #ifdef COREXY
+      if (idx==AXIS_1) {
+        axis_value[idx] = print_steps_to_coord_units(system_convert_corexy_to_x_axis_steps(steps), idx);
+        continue;
+      } else if (idx==AXIS_2) {
+        axis_value[idx] = print_steps_to_coord_units(system_convert_corexy_to_y_axis_steps(steps), idx);
+        continue;
+      }
+    #endif
+    axis_value[idx] = print_steps_to_coord_units(steps[idx], idx);
+  }
+}
 
 /*
 static void report_util_setting_string(uint8_t n) {
@@ -110,7 +147,7 @@ static void report_util_float_setting(uint8_t n, float val, uint8_t n_decimal) {
 // operation. Errors events can originate from the g-code parser, settings module, or asynchronously
 // from a critical error, such as a triggered hard limit. Interface should always monitor for these
 // responses.
-void report_status_message(uint8_t status_code)
+static void report_util_status_message(uint8_t status_code)
 {
   switch(status_code) {
     case STATUS_OK: // STATUS_OK
@@ -121,6 +158,15 @@ void report_status_message(uint8_t status_code)
       report_util_line_feed();
   }
 }
+void report_status_message(uint8_t status_code)
+{
+  // The response to a line requesting a long report follows the complete report.
+  if (report_pending) {
+    report_pending_status = status_code;
+    return;
+  }
+  report_util_status_message(status_code);
+}
 
 // Prints alarm messages.
 void report_alarm_message(uint8_t alarm_code)
@@ -162,65 +208,78 @@ void report_feedback_message(uint8_t message_code)
       printPgmString(PSTR("Restoring spindle")); break;
     case MESSAGE_SLEEP_MODE:
       printPgmString(PSTR("Sleeping")); break;
+    #ifdef ENABLE_JOB_CHECKPOINT
+      case MESSAGE_CHECKPOINT_REPLAY:
+        printPgmString(PSTR("Replaying")); break;
+      case MESSAGE_CHECKPOINT_RESUME:
+        printPgmString(PSTR("Resuming")); break;
+    #endif
   }
   report_util_feedback_line_feed();
 }
 
 
-// Welcome message
+// Welcome message. Follows the rest of a report still being printed, like the settings printed
+// upon an EEPROM read failure at power-up.
 void report_init_message()
 {
+  while (report_continue()) { }
   printPgmString(PSTR("\r\nGrbl " GRBL_VERSION " ['$' for help]\r\n"));
 }
 
 // Grbl help message
-void report_grbl_help() {
+static void report_grbl_help() {
   printPgmString(PSTR("[HLP:$$ $# $G $I $N $x=val $Nx=line $J=line $SLP $C $X $H ~ ! ? ctrl-x]\r\n"));
 }
 
 
-// Grbl global settings print out.
+// Prints one line of the Grbl global settings. Returns false past the last line.
 // NOTE: The numbering scheme here must correlate to storing in settings.c
-void report_grbl_settings() {
-  // Print Grbl settings.
-  report_util_uint8_setting(0,settings.pulse_microseconds);
-  report_util_uint8_setting(1,settings.stepper_idle_lock_time);
-  report_util_uint8_setting(2,settings.step_invert_mask);
-  report_util_uint8_setting(3,settings.dir_invert_mask);
-  report_util_uint8_setting(4,bit_istrue(settings.flags,BITFLAG_INVERT_ST_ENABLE));
-  report_util_uint8_setting(5,bit_istrue(settings.flags,BITFLAG_INVERT_LIMIT_PINS));
-  report_util_uint8_setting(6,bit_istrue(settings.flags,BITFLAG_INVERT_PROBE_PIN));
-  report_util_uint8_setting(10,settings.status_report_mask);
-  report_util_float_setting(11,settings.junction_deviation,N_DECIMAL_SETTINGVALUE);
-  report_util_float_setting(12,settings.arc_tolerance,N_DECIMAL_SETTINGVALUE);
-  report_util_uint8_setting(13,bit_istrue(settings.flags,BITFLAG_REPORT_INCHES));
-  report_util_uint8_setting(20,bit_istrue(settings.flags,BITFLAG_SOFT_LIMIT_ENABLE));
-  report_util_uint8_setting(21,bit_istrue(settings.flags,BITFLAG_HARD_LIMIT_ENABLE));
-  report_util_uint8_setting(22,bit_istrue(settings.flags,BITFLAG_HOMING_ENABLE));
-  report_util_uint8_setting(23,settings.homing_dir_mask);
-  report_util_float_setting(24,settings.homing_feed_rate,N_DECIMAL_SETTINGVALUE);
-  report_util_float_setting(25,settings.homing_seek_rate,N_DECIMAL_SETTINGVALUE);
-  report_util_uint8_setting(26,settings.homing_debounce_delay);
-  report_util_float_setting(27,settings.homing_pulloff,N_DECIMAL_SETTINGVALUE);
-  report_util_float_setting(30,settings.rpm_max,N_DECIMAL_RPMVALUE);
-  report_util_float_setting(31,settings.rpm_min,N_DECIMAL_RPMVALUE);
-  report_util_uint8_setting(32,bit_istrue(settings.flags,BITFLAG_LASER_MODE));
-  // Print axis settings
-  uint8_t idx, set_idx;
-  uint8_t val = AXIS_SETTINGS_START_VAL;
-  for (set_idx=0; set_idx<AXIS_N_SETTINGS; set_idx++) {
-    for (idx=0; idx<N_AXIS; idx++) {
+#define REPORT_GLOBAL_SETTINGS 24 // Lines of non-axis settings.
+static uint8_t report_grbl_settings_line(uint8_t line) {
+  switch (line) {
+    case 0: report_util_uint8_setting(0,settings.pulse_microseconds); break;
+    case 1: report_util_uint8_setting(1,settings.stepper_idle_lock_time); break;
+    case 2: report_util_uint8_setting(2,settings.step_invert_mask); break;
+    case 3: report_util_uint8_setting(3,settings.dir_invert_mask); break;
+    case 4: report_util_uint8_setting(4,bit_istrue(settings.flags,BITFLAG_INVERT_ST_ENABLE)); break;
+    case 5: report_util_uint8_setting(5,bit_istrue(settings.flags,BITFLAG_INVERT_LIMIT_PINS)); break;
+    case 6: report_util_uint8_setting(6,bit_istrue(settings.flags,BITFLAG_INVERT_PROBE_PIN)); break;
+    case 7: report_util_uint8_setting(10,settings.status_report_mask); break;
+    case 8: report_util_float_setting(11,settings.junction_deviation,N_DECIMAL_SETTINGVALUE); break;
+    case 9: report_util_float_setting(12,settings.arc_tolerance,N_DECIMAL_SETTINGVALUE); break;
+    case 10: report_util_uint8_setting(13,bit_istrue(settings.flags,BITFLAG_REPORT_INCHES)); break;
+    case 11: report_util_float_setting(14,settings.rotary_junction_deviation,N_DECIMAL_SETTINGVALUE); break;
+    case 12: report_util_uint8_setting(15,settings.rotary_wrap_mask); break;
+    case 13: report_util_uint8_setting(20,bit_istrue(settings.flags,BITFLAG_SOFT_LIMIT_ENABLE)); break;
+    case 14: report_util_uint8_setting(21,bit_istrue(settings.flags,BITFLAG_HARD_LIMIT_ENABLE)); break;
+    case 15: report_util_uint8_setting(22,bit_istrue(settings.flags,BITFLAG_HOMING_ENABLE)); break;
+    case 16: report_util_uint8_setting(23,settings.homing_dir_mask); break;
+    case 17: report_util_float_setting(24,settings.homing_feed_rate,N_DECIMAL_SETTINGVALUE); break;
+    case 18: report_util_float_setting(25,settings.homing_seek_rate,N_DECIMAL_SETTINGVALUE); break;
+    case 19: report_util_uint8_setting(26,settings.homing_debounce_delay); break;
+    case 20: report_util_float_setting(27,settings.homing_pulloff,N_DECIMAL_SETTINGVALUE); break;
+    case 21: report_util_float_setting(30,settings.rpm_max,N_DECIMAL_RPMVALUE); break;
+    case 22: report_util_float_setting(31,settings.rpm_min,N_DECIMAL_RPMVALUE); break;
+    case 23: report_util_uint8_setting(32,bit_istrue(settings.flags,BITFLAG_LASER_MODE)); break;
+    default: {
+      // Axis settings, in groups of all axes per setting.
+      line -= REPORT_GLOBAL_SETTINGS;
+      uint8_t set_idx = line/N_AXIS;
+      if (set_idx >= AXIS_N_SETTINGS) { return(false); }
+      uint8_t idx = line-set_idx*N_AXIS;
+      uint8_t val = AXIS_SETTINGS_START_VAL+set_idx*AXIS_SETTINGS_INCREMENT+idx;
       switch (set_idx) {
-        case 0: report_util_float_setting(val+idx,settings.steps_per_mm[idx],N_DECIMAL_SETTINGVALUE); break;
-        case 1: report_util_float_setting(val+idx,settings.max_rate[idx],N_DECIMAL_SETTINGVALUE); break;
-        case 2: report_util_float_setting(val+idx,settings.acceleration[idx]/(60*60),N_DECIMAL_SETTINGVALUE); break;
-        case 3: report_util_float_setting(val+idx,-settings.max_travel[idx],N_DECIMAL_SETTINGVALUE); break;
-        case 4: report_util_float_setting(val+idx,settings.current[idx],N_DECIMAL_SETTINGVALUE); break;
-        case 5: report_util_float_setting(val+idx,settings.endstop_adj[idx],N_DECIMAL_SETTINGVALUE); break;
+        case 0: report_util_float_setting(val,settings.steps_per_mm[idx],N_DECIMAL_SETTINGVALUE); break;
+        case 1: report_util_float_setting(val,settings.max_rate[idx],N_DECIMAL_SETTINGVALUE); break;
+        case 2: report_util_float_setting(val,settings.acceleration[idx]/(60*60),N_DECIMAL_SETTINGVALUE); break;
+        case 3: report_util_float_setting(val,-settings.max_travel[idx],N_DECIMAL_SETTINGVALUE); break;
+        case 4: report_util_float_setting(val,settings.current[idx],N_DECIMAL_SETTINGVALUE); break;
+        case 5: report_util_float_setting(val,settings.endstop_adj[idx],N_DECIMAL_SETTINGVALUE); break;
       }
     }
-    val += AXIS_SETTINGS_INCREMENT;
   }
+  return(true);
 }
 
 
@@ -231,42 +290,52 @@ void report_probe_parameters()
 {
   // Report in terms of machine position.
   printPgmString(PSTR("[PRB:"));
-  float print_position[N_AXIS];
-  system_convert_array_steps_to_mpos(print_position,sys_probe_position);
-  report_util_axis_values(print_position);
+  int32_t print_position[N_AXIS];
+  report_util_steps_to_coord_values(print_position,sys_probe_position);
+  report_util_axis_coord_values(print_position);
   serial_write(':');
   print_uint8_base10(sys.probe_succeeded);
   report_util_feedback_line_feed();
 }
 
 
-// Prints Grbl NGC parameters (coordinate offsets, probing)
-void report_ngc_parameters()
+// Prints one line of the Grbl NGC parameters (coordinate offsets, probing). Returns false past
+// the last line or upon an EEPROM read failure.
+static uint8_t report_ngc_parameters_line(uint8_t line)
 {
-  float coord_data[N_AXIS];
-  uint8_t coord_select;
-  for (coord_select = 0; coord_select <= SETTING_INDEX_NCOORD; coord_select++) {
-    if (!(settings_read_coord_data(coord_select,coord_data))) {
-      report_status_message(STATUS_SETTING_READ_FAIL);
-      return;
+  if (line <= SETTING_INDEX_NCOORD) {
+    float coord_data[N_AXIS];
+    if (!(settings_read_coord_data(line,coord_data))) {
+      report_util_status_message(STATUS_SETTING_READ_FAIL);
+      return(false);
     }
     printPgmString(PSTR("[G"));
-    switch (coord_select) {
+    switch (line) {
       case 6: printPgmString(PSTR("28")); break;
       case 7: printPgmString(PSTR("30")); break;
-      default: print_uint8_base10(coord_select+54); break; // G54-G59
+      default: print_uint8_base10(line+54); break; // G54-G59
     }
     serial_write(':');
     report_util_axis_values(coord_data);
     report_util_feedback_line_feed();
+    return(true);
   }
-  printPgmString(PSTR("[G92:")); // Print G92,G92.1 which are not persistent in memory
-  report_util_axis_values(gc_state.coord_offset);
-  report_util_feedback_line_feed();
-  printPgmString(PSTR("[TLO:")); // Print tool length offset value
-  printFloat_CoordValue(gc_state.tool_length_offset);
-  report_util_feedback_line_feed();
-  report_probe_parameters(); // Print probe parameters. Not persistent in memory.
+  line -= SETTING_INDEX_NCOORD; // Parameters that are not stored in EEPROM
+  switch (line) {
+    case 1:
+      printPgmString(PSTR("[G92:")); // Print G92,G92.1 which are not persistent in memory
+      report_util_axis_values(gc_state.coord_offset);
+      report_util_feedback_line_feed();
+      break;
+    case 2:
+      printPgmString(PSTR("[TLO:")); // Print tool length offset value
+      printFloat_CoordValue(gc_state.tool_length_offset);
+      report_util_feedback_line_feed();
+      break;
+    case 3: report_probe_parameters(); break; // Print probe parameters. Not persistent in memory.
+    default: return(false);
+  }
+  return(true);
 }
 
 
@@ -341,7 +410,7 @@ void report_gcode_modes()
 }
 
 // Prints specified startup line
-void report_startup_line(uint8_t n, char *line)
+static void report_startup_line(uint8_t n, char *line)
 {
   printPgmString(PSTR("$N"));
   print_uint8_base10(n);
@@ -350,6 +419,21 @@ void report_startup_line(uint8_t n, char *line)
   report_util_line_feed();
 }
 
+
+// Prints one of the startup lines. Returns false past the last line.
+static uint8_t report_startup_lines_line(uint8_t n)
+{
+  if (n >= N_STARTUP_LINE) { return(false); }
+  char line[LINE_BUFFER_SIZE];
+  if (!(settings_read_startup_line(n, line))) {
+    report_util_status_message(STATUS_SETTING_READ_FAIL);
+  } else {
+    report_startup_line(n, line);
+  }
+  return(true);
+}
+
+
 void report_execute_startup_message(char *line, uint8_t status_code)
 {
   serial_write('>');
@@ -358,93 +442,157 @@ void report_execute_startup_message(char *line, uint8_t status_code)
   report_status_message(status_code);
 }
 
-// Prints build info line
-void report_build_info(char *line)
+// Prints one line of the build info. Returns false past the last line.
+static uint8_t report_build_info_line(uint8_t line)
 {
-  printPgmString(PSTR("[VER:" GRBL_VERSION "." GRBL_VERSION_BUILD ":"));
-  printString(line);
-  report_util_feedback_line_feed();
-  printPgmString(PSTR("[AXS:"));
-  print_uint8_base10(N_AXIS);
-  printPgmString(PSTR(":"));
-  serial_write(AXIS_1_NAME);
-  serial_write(AXIS_2_NAME);
-  serial_write(AXIS_3_NAME);
-  #if N_AXIS > 3
-    serial_write(AXIS_4_NAME);
-  #endif
-  #if N_AXIS > 4
-    serial_write(AXIS_5_NAME);
-  #endif
-  #if N_AXIS > 5
-    serial_write(AXIS_6_NAME);
-  #endif
-  report_util_feedback_line_feed();
-  printPgmString(PSTR("[OPT:")); // Generate compile-time build option list
-  serial_write('V');
-  serial_write('N');
-  serial_write('M');
-  #ifdef COREXY
-    serial_write('C');
-  #endif
-  #ifdef PARKING_ENABLE
-    serial_write('P');
-  #endif
-  #ifdef HOMING_FORCE_SET_ORIGIN
-    serial_write('Z');
-  #endif
-  #ifdef HOMING_SINGLE_AXIS_COMMANDS
-    serial_write('H');
-  #endif
-  #ifdef LIMITS_TWO_SWITCHES_ON_AXES
-    serial_write('T');
-  #endif
-  #ifdef ALLOW_FEED_OVERRIDE_DURING_PROBE_CYCLES
-    serial_write('A');
-  #endif
-  #ifdef USE_SPINDLE_DIR_AS_ENABLE_PIN
-    serial_write('D');
-  #endif
-  #ifdef SPINDLE_ENABLE_OFF_WITH_ZERO_SPEED
-    serial_write('0');
-  #endif
-  #ifdef ENABLE_SOFTWARE_DEBOUNCE
-    serial_write('S');
-  #endif
-  #ifdef ENABLE_PARKING_OVERRIDE_CONTROL
-    serial_write('R');
-  #endif
-  #ifndef ENABLE_RESTORE_EEPROM_WIPE_ALL // NOTE: Shown when disabled.
-    serial_write('*');
-  #endif
-  #ifndef ENABLE_RESTORE_EEPROM_DEFAULT_SETTINGS // NOTE: Shown when disabled.
-    serial_write('$');
-  #endif
-  #ifndef ENABLE_RESTORE_EEPROM_CLEAR_PARAMETERS // NOTE: Shown when disabled.
-    serial_write('#');
-  #endif
-  #ifndef ENABLE_BUILD_INFO_WRITE_COMMAND // NOTE: Shown when disabled.
-    serial_write('I');
-  #endif
-  #ifndef FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE // NOTE: Shown when disabled.
-    serial_write('E');
-  #endif
-  #ifndef FORCE_BUFFER_SYNC_DURING_WCO_CHANGE // NOTE: Shown when disabled.
-    serial_write('W');
-  #endif
-  #ifndef HOMING_INIT_LOCK
-    serial_write('L');
-  #endif
+  switch (line) {
+    case 0: {
+      char info[LINE_BUFFER_SIZE];
+      settings_read_build_info(info);
+      printPgmString(PSTR("[VER:" GRBL_VERSION "." GRBL_VERSION_BUILD ":"));
+      printString(info);
+      report_util_feedback_line_feed();
+      break;
+    }
+    case 1:
+      printPgmString(PSTR("[AXS:"));
+      print_uint8_base10(N_AXIS);
+      printPgmString(PSTR(":"));
+      serial_write(AXIS_1_NAME);
+      serial_write(AXIS_2_NAME);
+      serial_write(AXIS_3_NAME);
+      #if N_AXIS > 3
+        serial_write(AXIS_4_NAME);
+      #endif
+      #if N_AXIS > 4
+        serial_write(AXIS_5_NAME);
+      #endif
+      #if N_AXIS > 5
+        serial_write(AXIS_6_NAME);
+      #endif
+      report_util_feedback_line_feed();
+      break;
+    case 2:
+      printPgmString(PSTR("[OPT:")); // Generate compile-time build option list
+      serial_write('V');
+      serial_write('N');
+      serial_write('M');
+      #ifdef COREXY
+        serial_write('C');
+      #endif
+      #ifdef PARKING_ENABLE
+        serial_write('P');
+      #endif
+      #ifdef HOMING_FORCE_SET_ORIGIN
+        serial_write('Z');
+      #endif
+      #ifdef HOMING_SINGLE_AXIS_COMMANDS
+        serial_write('H');
+      #endif
+      #ifdef LIMITS_TWO_SWITCHES_ON_AXES
+        serial_write('T');
+      #endif
+      #ifdef ALLOW_FEED_OVERRIDE_DURING_PROBE_CYCLES
+        serial_write('A');
+      #endif
+      #ifdef USE_SPINDLE_DIR_AS_ENABLE_PIN
+        serial_write('D');
+      #endif
+      #ifdef SPINDLE_ENABLE_OFF_WITH_ZERO_SPEED
+        serial_write('0');
+      #endif
+      #ifdef ENABLE_SOFTWARE_DEBOUNCE
+        serial_write('S');
+      #endif
+      #ifdef ENABLE_PARKING_OVERRIDE_CONTROL
+        serial_write('R');
+      #endif
+      #ifndef ENABLE_RESTORE_EEPROM_WIPE_ALL // NOTE: Shown when disabled.
+        serial_write('*');
+      #endif
+      #ifndef ENABLE_RESTORE_EEPROM_DEFAULT_SETTINGS // NOTE: Shown when disabled.
+        serial_write('$');
+      #endif
+      #ifndef ENABLE_RESTORE_EEPROM_CLEAR_PARAMETERS // NOTE: Shown when disabled.
+        serial_write('#');
+      #endif
+      #ifndef ENABLE_BUILD_INFO_WRITE_COMMAND // NOTE: Shown when disabled.
+        serial_write('I');
+      #endif
+      #ifndef FORCE_BUFFER_SYNC_DURING_EEPROM_WRITE // NOTE: Shown when disabled.
+        serial_write('E');
+      #endif
+      #ifndef FORCE_BUFFER_SYNC_DURING_WCO_CHANGE // NOTE: Shown when disabled.
+        serial_write('W');
+      #endif
+      #ifndef HOMING_INIT_LOCK
+        serial_write('L');
+      #endif
+
+      // NOTE: Compiled values, like override increments/max/min values, may be added at some point later.
+      serial_write(',');
+      print_uint8_base10(BLOCK_BUFFER_SIZE-1);
+      serial_write(',');
+      print_uint8_base10(RX_BUFFER_SIZE);
+      serial_write(',');
+      print_uint8_base10(settings.flags);
 
-  // NOTE: Compiled values, like override increments/max/min values, may be added at some point later.
-  serial_write(',');
-  print_uint8_base10(BLOCK_BUFFER_SIZE-1);
-  serial_write(',');
-  print_uint8_base10(RX_BUFFER_SIZE);
-  serial_write(',');
-  print_uint8_base10(settings.flags);
+      report_util_feedback_line_feed();
+      break;
+    default: return(false);
+  }
+  return(true);
+}
 
-  report_util_feedback_line_feed();
+
+// Starts one of the reports requested by '$' commands. The report is printed a line at a
+// time by report_continue(), whenever the TX buffer has room for a complete line, so it never
+// waits on the serial port and holds up the main loop. The status message of the requesting line
+// is held back until the report is complete.
+void report_start(uint8_t report)
+{
+  report_pending = report;
+  report_pending_line = 0;
+  report_pending_status = REPORT_STATUS_NONE;
+  report_continue();
+}
+
+
+// Prints the next lines of the started report, as many as the TX buffer has room for. Returns
+// true while the report is incomplete. Called by the main loop, which executes no other lines
+// until then.
+uint8_t report_continue()
+{
+  while (report_pending) {
+    if (serial_get_tx_buffer_available() < REPORT_LINE_MAX) { return(true); }
+    uint8_t printed;
+    switch (report_pending) {
+      case REPORT_SETTINGS: printed = report_grbl_settings_line(report_pending_line); break;
+      case REPORT_NGC_PARAMETERS: printed = report_ngc_parameters_line(report_pending_line); break;
+      case REPORT_BUILD_INFO: printed = report_build_info_line(report_pending_line); break;
+      case REPORT_STARTUP_LINES: printed = report_startup_lines_line(report_pending_line); break;
+      default: // Single line reports
+        printed = (report_pending_line == 0);
+        if (printed) {
+          if (report_pending == REPORT_GCODE_MODES) { report_gcode_modes(); }
+          else { report_grbl_help(); } // REPORT_HELP
+        }
+    }
+    if (printed) {
+      report_pending_line++;
+    } else {
+      report_pending = REPORT_NONE;
+      if (report_pending_status != REPORT_STATUS_NONE) { report_util_status_message(report_pending_status); }
+    }
+  }
+  return(false);
+}
+
+
+// Drops an incomplete report and its held back status message upon a reset.
+void report_reset()
+{
+  report_pending = REPORT_NONE;
 }
 
 
@@ -467,8 +615,8 @@ void report_realtime_status()
   uint8_t idx;
   int32_t current_position[N_AXIS]; // Copy current state of the system position variable
   memcpy(current_position,sys_position,sizeof(sys_position));
-  float print_position[N_AXIS];
-  system_convert_array_steps_to_mpos(print_position,current_position);
+  int32_t print_position[N_AXIS];
+  report_util_steps_to_coord_values(print_position,current_position);
 
   // Report current machine state and sub-states
   serial_write('<');
@@ -513,7 +661,7 @@ void report_realtime_status()
       wco[idx] = gc_state.coord_system[idx]+gc_state.coord_offset[idx];
       if (idx == TOOL_LENGTH_OFFSET_AXIS) { wco[idx] += gc_state.tool_length_offset; }
       if (bit_isfalse(settings.status_report_mask,BITFLAG_RT_STATUS_POSITION_TYPE)) {
-        print_position[idx] -= wco[idx];
+        print_position[idx] -= print_mm_to_coord_units(wco[idx]);
       }
     }
   }
@@ -524,7 +672,7 @@ void report_realtime_status()
   } else {
     printPgmString(PSTR("|WPos:"));
   }
-  report_util_axis_values(print_position);
+  report_util_axis_coord_values(print_position);
 
   // Returns planner and serial read buffer states.
   #ifdef REPORT_FIELD_BUFFER_STATE
@@ -554,6 +702,10 @@ void report_realtime_status()
     printFloat_RateValue(st_get_realtime_rate());
     serial_write(',');
     printFloat(sys.spindle_speed,N_DECIMAL_RPMVALUE);
+    #ifdef SPINDLE_AT_SPEED
+      serial_write(',');
+      printFloat(spindle_get_rpm(),N_DECIMAL_RPMVALUE);
+    #endif
   #endif
 
   #ifdef REPORT_FIELD_PIN_STATE
@@ -632,9 +784,77 @@ void report_realtime_status()
 }
 
 
+#ifdef ENABLE_PERFORMANCE_COUNTERS
+  // Prints the runtime performance counters. Times are in microseconds as worst-case,average.
+  // ISR:stepper ISR, SEG:segment buffer underruns, PLN:planner buffer empty events, LOOP:main loop
+  // iteration, RCL:planner recalculation pass length in blocks, BLT:blocks limited by the minimum
+  // block time, RXD:serial RX characters dropped.
+  void report_perf_counters()
+  {
+    perf_t snapshot;
+    uint8_t sreg = SREG;
+    cli();
+    memcpy(&snapshot, (perf_t *)&perf, sizeof(perf_t));
+    SREG = sreg;
+
+    printPgmString(PSTR("[PRF:ISR:"));
+    printFloat(snapshot.step_isr_max/(float)TICKS_PER_MICROSECOND, 1);
+    serial_write(',');
+    printFloat(snapshot.step_isr_avg/(float)(TICKS_PER_MICROSECOND << PERF_AVG_SHIFT), 1);
+    printPgmString(PSTR("|SEG:"));
+    print_uint32_base10(snapshot.segment_underrun);
+    printPgmString(PSTR("|PLN:"));
+    print_uint32_base10(snapshot.planner_empty);
+    printPgmString(PSTR("|LOOP:"));
+    printFloat(snapshot.loop_max/PERF_LOOP_TICKS_PER_MICROSECOND, 0);
+    serial_write(',');
+    printFloat(snapshot.loop_avg/(PERF_LOOP_TICKS_PER_MICROSECOND*bit(PERF_AVG_SHIFT)), 0);
+    printPgmString(PSTR("|RCL:"));
+    print_uint8_base10(snapshot.recalc_max);
+    serial_write(',');
+    printFloat(snapshot.recalc_avg/(float)bit(PERF_AVG_SHIFT), 1);
+    printPgmString(PSTR("|BLT:"));
+    print_uint32_base10(snapshot.block_time_limited);
+    printPgmString(PSTR("|RXD:"));
+    print_uint32_base10(snapshot.rx_overflow);
+    printPgmString(PSTR("|MEM:"));
+    print_uint32_base10(perf_get_free_ram());
+    serial_write(',');
+    print_uint32_base10(perf_get_stack_free_min());
+    report_util_feedback_line_feed();
+  }
+#endif
+
+
+#ifdef ENABLE_JOB_CHECKPOINT
+  // Prints the last numbered line executed to completion and the machine position where the last
+  // job was interrupted.
+  void report_checkpoint()
+  {
+    int32_t line_number;
+    int32_t position[N_AXIS];
+    uint8_t sreg = SREG;
+    cli();
+    line_number = checkpoint.line_number;
+    memcpy(position, (int32_t *)checkpoint.position, sizeof(position));
+    SREG = sreg;
+
+    printPgmString(PSTR("[CKP:"));
+    print_uint32_base10(line_number);
+    serial_write(':');
+    int32_t print_position[N_AXIS];
+    report_util_steps_to_coord_values(print_position,position);
+    report_util_axis_coord_values(print_position);
+    report_util_feedback_line_feed();
+  }
+#endif
+
+
 #ifdef DEBUG
   void report_realtime_debug()
   {
-
+    printPgmString(PSTR("[DBG:RXO:"));
+    print_uint32_base10(serial_get_rx_overrun_count());
+    report_util_feedback_line_feed();
   }
 #endif
@@ -83,6 +83,8 @@
 #define MESSAGE_RESTORE_DEFAULTS 9
 #define MESSAGE_SPINDLE_RESTORE 10
 #define MESSAGE_SLEEP_MODE 11
+#define MESSAGE_CHECKPOINT_REPLAY 12
+#define MESSAGE_CHECKPOINT_RESUME 13
 
 // Prints system status messages.
 void report_status_message(uint8_t status_code);
@@ -96,11 +98,28 @@ void report_feedback_message(uint8_t message_code);
 // Prints welcome message
 void report_init_message();
 
-// Prints Grbl help and current global settings
-void report_grbl_help();
+// Reports, started by report_start() and printed a line at a time by report_continue().
+#define REPORT_NONE           0
+#define REPORT_SETTINGS       1 // '$$', and upon an EEPROM read failure at power-up.
+#define REPORT_NGC_PARAMETERS 2 // '$#'
+#define REPORT_GCODE_MODES    3 // '$G'
+#define REPORT_BUILD_INFO     4 // '$I'
+#define REPORT_STARTUP_LINES  5 // '$N'
+#define REPORT_HELP           6 // '$'
 
-// Prints Grbl global settings
-void report_grbl_settings();
+// Room in the TX buffer needed to print the next line of a report. Fits the longest line with
+// fixed content, six axes of ten integer digits each in the [PRB:] line. Build info and startup
+// lines hold user text and may be longer, so they can still wait on the TX buffer for the rest.
+#define REPORT_LINE_MAX 112
+
+// Starts printing a report from the main loop. Holds back the next status message until done.
+void report_start(uint8_t report);
+
+// Prints the next lines of the started report that fit the TX buffer. Returns true while incomplete.
+uint8_t report_continue();
+
+// Drops an incomplete report upon a reset.
+void report_reset();
 
 // Prints an echo of the pre-parsed line received right before execution.
 void report_echo_line_received(char *line);
@@ -111,18 +130,21 @@ void report_realtime_status();
 // Prints recorded probe position
 void report_probe_parameters();
 
-// Prints Grbl NGC parameters (coordinate offsets, probe)
-void report_ngc_parameters();
-
 // Prints current g-code parser mode state
 void report_gcode_modes();
 
-// Prints startup line when requested and executed.
-void report_startup_line(uint8_t n, char *line);
+// Prints startup line when executed.
 void report_execute_startup_message(char *line, uint8_t status_code);
 
-// Prints build info and user info
-void report_build_info(char *line);
+#ifdef ENABLE_PERFORMANCE_COUNTERS
+  // Prints the runtime performance counters.
+  void report_perf_counters();
+#endif
+
+#ifdef ENABLE_JOB_CHECKPOINT
+  // Prints the job checkpoint.
+  void report_checkpoint();
+#endif
 
 #ifdef DEBUG
   void report_realtime_debug();
@@ -25,6 +25,96 @@
 #define RX_RING_BUFFER (RX_BUFFER_SIZE+1)
 #define TX_RING_BUFFER (TX_BUFFER_SIZE+1)
 
+// Baud rate register value and the resulting actual baud rate. Above 57600 baud, the U2X double
+// speed mode is used, which halves the divisor granularity. At 16MHz, 250k, 500k, 1M and 2M baud
+// are exact, while the classic rates carry a few percent of error.
+#if BAUD_RATE < 57600
+  #define SERIAL_UBRR_VALUE   (((F_CPU / (8L * BAUD_RATE)) - 1)/2)
+  #define SERIAL_BAUD_ACTUAL  (F_CPU / (16L * (SERIAL_UBRR_VALUE + 1)))
+#else
+  #define SERIAL_UBRR_VALUE   (((F_CPU / (4L * BAUD_RATE)) - 1)/2)
+  #define SERIAL_BAUD_ACTUAL  (F_CPU / (8L * (SERIAL_UBRR_VALUE + 1)))
+#endif
+#if (SERIAL_UBRR_VALUE < 0) || (SERIAL_UBRR_VALUE > 4095)
+  #error "BAUD_RATE can not be generated from F_CPU."
+#endif
+#if (SERIAL_BAUD_ACTUAL*1000L > BAUD_RATE*1025L) || (SERIAL_BAUD_ACTUAL*1000L < BAUD_RATE*975L)
+  #warning "BAUD_RATE error exceeds 2.5% with this F_CPU. Communication may be unreliable."
+#endif
+
+// Receive byte classes. Every incoming byte is classified by a single flash lookup, so ordinary
+// g-code characters take the shortest possible path to the RX ring buffer. Realtime commands are
+// encoded as a class in the upper nibble and, for executor flags, the flag bit index in the lower.
+#define RX_CLASS_BUFFER         0x00 // Store in RX ring buffer. Must be zero.
+#define RX_CLASS_DISCARD        0x10 // Unknown extended-ASCII character. Thrown away.
+#define RX_CLASS_EXEC_STATE     0x20 // Sets a sys_rt_exec_state flag.
+#define RX_CLASS_EXEC_MOTION    0x30 // Sets a sys_rt_exec_motion_override flag.
+#define RX_CLASS_EXEC_ACCESSORY 0x40 // Sets a sys_rt_exec_accessory_override flag.
+#define RX_CLASS_RESET          0x50
+#define RX_CLASS_JOG_CANCEL     0x60
+#define RX_CLASS_DEBUG_REPORT   0x70
+#define RX_CLASS_MASK           0xF0
+#ifdef ENABLE_RX_LINE_ASSEMBLY
+  // Line filter classes. Must be greater than all realtime command classes.
+  #define RX_CLASS_FILTER         0x80
+  #define RX_CLASS_SKIP           0x80 // Whitespace, control characters and block delete.
+  #define RX_CLASS_LOWERCASE      0x90
+  #define RX_CLASS_EOL            0xA0
+  #define RX_CLASS_COMMENT_OPEN   0xB0
+  #define RX_CLASS_COMMENT_CLOSE  0xC0
+  #define RX_CLASS_COMMENT_EOL    0xD0
+
+  // Line assembly flags. Includes comment type tracking and line overflow detection.
+  #define RX_LINE_FLAG_OVERFLOW bit(0)
+  #define RX_LINE_FLAG_COMMENT_PARENTHESES bit(1)
+  #define RX_LINE_FLAG_COMMENT_SEMICOLON bit(2)
+#endif
+
+#define RX_FLAG_INDEX(mask) ((((mask)&0xAA)?1:0)|(((mask)&0xCC)?2:0)|(((mask)&0xF0)?4:0))
+#define RX_STATE(mask)      (RX_CLASS_EXEC_STATE|RX_FLAG_INDEX(mask))
+#define RX_MOTION(mask)     (RX_CLASS_EXEC_MOTION|RX_FLAG_INDEX(mask))
+#define RX_ACCESSORY(mask)  (RX_CLASS_EXEC_ACCESSORY|RX_FLAG_INDEX(mask))
+
+// NOTE: Realtime control characters outside of the four legacy ones are extended ASCII only.
+static const uint8_t serial_rx_class[256] PROGMEM = {
+  #ifdef ENABLE_RX_LINE_ASSEMBLY
+    [0x00 ... ' '] = RX_CLASS_SKIP,
+    ['a' ... 'z'] = RX_CLASS_LOWERCASE,
+    ['\n'] = RX_CLASS_EOL,
+    ['\r'] = RX_CLASS_EOL,
+    ['/'] = RX_CLASS_SKIP, // Block delete NOT SUPPORTED. Ignore character.
+    ['('] = RX_CLASS_COMMENT_OPEN,
+    [')'] = RX_CLASS_COMMENT_CLOSE,
+    [';'] = RX_CLASS_COMMENT_EOL, // NOTE: ';' comment to EOL is a LinuxCNC definition. Not NIST.
+  #endif
+  [0x80 ... 0xFF] = RX_CLASS_DISCARD,
+  [CMD_RESET] = RX_CLASS_RESET,
+  [CMD_STATUS_REPORT] = RX_STATE(EXEC_STATUS_REPORT),
+  [CMD_CYCLE_START] = RX_STATE(EXEC_CYCLE_START),
+  [CMD_FEED_HOLD] = RX_STATE(EXEC_FEED_HOLD),
+  [CMD_SAFETY_DOOR] = RX_STATE(EXEC_SAFETY_DOOR),
+  [CMD_JOG_CANCEL] = RX_CLASS_JOG_CANCEL,
+  #ifdef DEBUG
+    [CMD_DEBUG_REPORT] = RX_CLASS_DEBUG_REPORT,
+  #endif
+  [CMD_FEED_OVR_RESET] = RX_MOTION(EXEC_FEED_OVR_RESET),
+  [CMD_FEED_OVR_COARSE_PLUS] = RX_MOTION(EXEC_FEED_OVR_COARSE_PLUS),
+  [CMD_FEED_OVR_COARSE_MINUS] = RX_MOTION(EXEC_FEED_OVR_COARSE_MINUS),
+  [CMD_FEED_OVR_FINE_PLUS] = RX_MOTION(EXEC_FEED_OVR_FINE_PLUS),
+  [CMD_FEED_OVR_FINE_MINUS] = RX_MOTION(EXEC_FEED_OVR_FINE_MINUS),
+  [CMD_RAPID_OVR_RESET] = RX_MOTION(EXEC_RAPID_OVR_RESET),
+  [CMD_RAPID_OVR_MEDIUM] = RX_MOTION(EXEC_RAPID_OVR_MEDIUM),
+  [CMD_RAPID_OVR_LOW] = RX_MOTION(EXEC_RAPID_OVR_LOW),
+  [CMD_SPINDLE_OVR_RESET] = RX_ACCESSORY(EXEC_SPINDLE_OVR_RESET),
+  [CMD_SPINDLE_OVR_COARSE_PLUS] = RX_ACCESSORY(EXEC_SPINDLE_OVR_COARSE_PLUS),
+  [CMD_SPINDLE_OVR_COARSE_MINUS] = RX_ACCESSORY(EXEC_SPINDLE_OVR_COARSE_MINUS),
+  [CMD_SPINDLE_OVR_FINE_PLUS] = RX_ACCESSORY(EXEC_SPINDLE_OVR_FINE_PLUS),
+  [CMD_SPINDLE_OVR_FINE_MINUS] = RX_ACCESSORY(EXEC_SPINDLE_OVR_FINE_MINUS),
+  [CMD_SPINDLE_OVR_STOP] = RX_ACCESSORY(EXEC_SPINDLE_OVR_STOP),
+  [CMD_COOLANT_FLOOD_OVR_TOGGLE] = RX_ACCESSORY(EXEC_COOLANT_FLOOD_OVR_TOGGLE),
+  [CMD_COOLANT_MIST_OVR_TOGGLE] = RX_ACCESSORY(EXEC_COOLANT_MIST_OVR_TOGGLE),
+};
+
 uint8_t serial_rx_buffer[RX_RING_BUFFER];
 uint8_t serial_rx_buffer_head = 0;
 volatile uint8_t serial_rx_buffer_tail = 0;
@@ -32,6 +122,28 @@ volatile uint8_t serial_rx_buffer_tail = 0;
 uint8_t serial_tx_buffer[TX_RING_BUFFER];
 uint8_t serial_tx_buffer_head = 0;
 volatile uint8_t serial_tx_buffer_tail = 0;
+uint8_t serial_tx_reserve_head; // Write position within space reserved by serial_write_reserve().
+
+#ifdef SERIAL_FLOW_CONTROL
+  volatile uint8_t serial_flow_state = FLOW_STATE_RESUMED;
+#endif
+
+#ifdef ENABLE_RX_LINE_ASSEMBLY
+  // Line assembly state of the RX interrupt. The main program only ever consumes complete lines,
+  // all located ahead of serial_rx_line_start, which is where the line being received begins.
+  uint8_t serial_rx_line_start = 0;
+  uint8_t serial_rx_line_length = 0;
+  uint8_t serial_rx_line_flags = 0;
+  volatile uint8_t serial_rx_line_count = 0; // Complete lines in the RX buffer.
+
+  // Line currently held by the main program, from the buffer tail through its terminator.
+  uint8_t serial_rx_line_end;
+  uint8_t serial_rx_line_held = false;
+#endif
+
+// Number of UART hardware data overruns, i.e. the RX interrupt was held off for longer than the
+// two-byte receive FIFO could cover. Each overrun loses one or more bytes. See 'make serial_soak'.
+volatile uint16_t serial_rx_overrun_count = 0;
 
 
 // Returns the number of bytes available in the RX serial buffer.
@@ -44,7 +156,7 @@ uint8_t serial_get_rx_buffer_available()
 
 
 // Returns the number of bytes used in the RX serial buffer.
-// NOTE: Deprecated. Not used unless classic status reports are enabled in config.h.
+// NOTE: Only used by the serial flow control options in config.h.
 uint8_t serial_get_rx_buffer_count()
 {
   uint8_t rtail = serial_rx_buffer_tail; // Copy to limit multiple calls to volatile
@@ -63,14 +175,53 @@ uint8_t serial_get_tx_buffer_count()
 }
 
 
+// Returns the number of bytes available in the TX serial buffer.
+uint8_t serial_get_tx_buffer_available()
+{
+  return(TX_BUFFER_SIZE - serial_get_tx_buffer_count());
+}
+
+
+#ifdef SERIAL_FLOW_CONTROL
+  // Signals the host to stop sending. Called by the RX interrupt when the buffer reaches the
+  // high watermark. With XON/XOFF, the XOFF character jumps ahead of any queued TX data.
+  static void serial_flow_stop()
+  {
+    #ifdef ENABLE_RTS_FLOW_CONTROL
+      SERIAL_RTS_PORT |= (1<<SERIAL_RTS_BIT); // De-assert RTS. Active low.
+      serial_flow_state = FLOW_STATE_STOPPED;
+    #else
+      serial_flow_state = FLOW_STATE_SEND_STOP;
+      UCSR0B |= (1 << UDRIE0); // Force TX
+    #endif
+  }
+
+
+  // Signals the host to resume sending. Called by the main program once the buffer has drained
+  // below the low watermark. Interrupts are disabled to protect the shared port and UCSR0B.
+  static void serial_flow_resume()
+  {
+    uint8_t sreg = SREG;
+    cli();
+    #ifdef ENABLE_RTS_FLOW_CONTROL
+      SERIAL_RTS_PORT &= ~(1<<SERIAL_RTS_BIT); // Assert RTS.
+      serial_flow_state = FLOW_STATE_RESUMED;
+    #else
+      serial_flow_state = FLOW_STATE_SEND_RESUME;
+      UCSR0B |= (1 << UDRIE0); // Force TX
+    #endif
+    SREG = sreg;
+  }
+#endif
+
+
 void serial_init()
 {
   // Set baud rate
+  uint16_t UBRR0_value = SERIAL_UBRR_VALUE;
   #if BAUD_RATE < 57600
-    uint16_t UBRR0_value = ((F_CPU / (8L * BAUD_RATE)) - 1)/2 ;
     UCSR0A &= ~(1 << U2X0); // baud doubler off  - Only needed on Uno XXX
   #else
-    uint16_t UBRR0_value = ((F_CPU / (4L * BAUD_RATE)) - 1)/2;
     UCSR0A |= (1 << U2X0);  // baud doubler on for high baud rates, i.e. 115200
   #endif
   UBRR0H = UBRR0_value >> 8;
@@ -80,6 +231,11 @@ void serial_init()
   UCSR0B |= (1<<RXEN0 | 1<<TXEN0 | 1<<RXCIE0);
 
   // defaults to 8-bit, no parity, 1 stop bit
+
+  #ifdef ENABLE_RTS_FLOW_CONTROL
+    SERIAL_RTS_DDR |= (1<<SERIAL_RTS_BIT); // Configure as output pin.
+    SERIAL_RTS_PORT &= ~(1<<SERIAL_RTS_BIT); // Assert RTS. Ready to receive.
+  #endif
 }
 
 
@@ -91,7 +247,6 @@ void serial_write(uint8_t data) {
 
   // Wait until there is space in the buffer
   while (next_head == serial_tx_buffer_tail) {
-    // TODO: Restructure st_prep_buffer() calls to be executed here during a long print.
     if (sys_rt_exec_state & EXEC_RESET) { return; } // Only check for abort to avoid an endless loop.
   }
 
@@ -104,19 +259,98 @@ void serial_write(uint8_t data) {
 }
 
 
+// Writes a block of bytes to the TX serial buffer, copying as many as fit at once, instead of
+// one call per byte. Called by main program.
+void serial_write_buffer(const uint8_t *data, uint8_t length)
+{
+  while (length) {
+    uint8_t head = serial_tx_buffer_head;
+    uint8_t ttail = serial_tx_buffer_tail; // Copy to limit multiple calls to volatile
+    uint16_t n;
+    if (head >= ttail) {
+      n = TX_RING_BUFFER-head; // Contiguous space up to the end of the ring.
+      if (ttail == 0) { n--; } // Keep one slot free to tell a full ring from an empty one.
+    } else {
+      n = ttail-head-1;
+    }
+    if (n == 0) {
+      // Wait until there is space in the buffer
+      if (sys_rt_exec_state & EXEC_RESET) { return; } // Only check for abort to avoid an endless loop.
+      continue;
+    }
+    if (n > length) { n = length; }
+
+    memcpy(&serial_tx_buffer[head], data, n);
+    head += n;
+    if (head == TX_RING_BUFFER) { head = 0; }
+    serial_tx_buffer_head = head;
+    data += n;
+    length -= n;
+
+    // Enable Data Register Empty Interrupt to make sure tx-streaming is running
+    UCSR0B |=  (1 << UDRIE0);
+  }
+}
+
+
+// Reserves room for a number of bytes in the TX serial buffer, waiting for it as needed. The bytes
+// are then stored by serial_write_reserved() without any further checks, and handed over to the
+// TX interrupt all at once by serial_write_commit(). Returns false, if aborted by a reset.
+// NOTE: The length must not exceed TX_BUFFER_SIZE.
+uint8_t serial_write_reserve(uint8_t length)
+{
+  serial_tx_reserve_head = serial_tx_buffer_head;
+  while (serial_get_tx_buffer_available() < length) {
+    if (sys_rt_exec_state & EXEC_RESET) { return(false); } // Only check for abort to avoid an endless loop.
+  }
+  return(true);
+}
+
+
+// Stores one byte in the space reserved by serial_write_reserve().
+void serial_write_reserved(uint8_t data)
+{
+  serial_tx_buffer[serial_tx_reserve_head] = data;
+  uint8_t next_head = serial_tx_reserve_head + 1;
+  if (next_head == TX_RING_BUFFER) { next_head = 0; }
+  serial_tx_reserve_head = next_head;
+}
+
+
+// Releases all bytes stored since serial_write_reserve() for transmission.
+void serial_write_commit()
+{
+  serial_tx_buffer_head = serial_tx_reserve_head;
+
+  // Enable Data Register Empty Interrupt to make sure tx-streaming is running
+  UCSR0B |=  (1 << UDRIE0);
+}
+
+
 // Data Register Empty Interrupt handler
 ISR(SERIAL_UDRE)
 {
   uint8_t tail = serial_tx_buffer_tail; // Temporary serial_tx_buffer_tail (to optimize for volatile)
 
-  // Send a byte from the buffer
-  UDR0 = serial_tx_buffer[tail];
+  #ifdef ENABLE_XONXOFF
+    if (serial_flow_state == FLOW_STATE_SEND_STOP) {
+      UDR0 = XOFF_CHAR;
+      serial_flow_state = FLOW_STATE_STOPPED;
+    } else if (serial_flow_state == FLOW_STATE_SEND_RESUME) {
+      UDR0 = XON_CHAR;
+      serial_flow_state = FLOW_STATE_RESUMED;
+    } else
+  #endif
+  {
+    // Send a byte from the buffer
+    UDR0 = serial_tx_buffer[tail];
 
-  // Update tail position
-  tail++;
-  if (tail == TX_RING_BUFFER) { tail = 0; }
+    // Update tail position
+    tail++;
+    if (tail == TX_RING_BUFFER) { tail = 0; }
 
-  serial_tx_buffer_tail = tail;
+    serial_tx_buffer_tail = tail;
+  }
 
   // Turn off Data Register Empty Interrupt to stop tx-streaming if this concludes the transfer
   if (tail == serial_tx_buffer_head) { UCSR0B &= ~(1 << UDRIE0); }
@@ -136,71 +370,231 @@ uint8_t serial_read()
     if (tail == RX_RING_BUFFER) { tail = 0; }
     serial_rx_buffer_tail = tail;
 
+    #ifdef SERIAL_FLOW_CONTROL
+      if ((serial_flow_state == FLOW_STATE_STOPPED) && (serial_get_rx_buffer_count() < RX_BUFFER_FLOW_LOW)) {
+        serial_flow_resume();
+      }
+    #endif
+
     return data;
   }
 }
 
 
+// Writes a byte to the RX ring buffer. Returns false, if the buffer is full. Called by RX ISR.
+static inline uint8_t serial_rx_store(uint8_t data)
+{
+  uint8_t next_head = serial_rx_buffer_head + 1;
+  if (next_head == RX_RING_BUFFER) { next_head = 0; }
+  if (next_head == serial_rx_buffer_tail) {
+    #ifdef ENABLE_PERFORMANCE_COUNTERS
+      perf.rx_overflow++;
+    #endif
+    return(false);
+  }
+
+  serial_rx_buffer[serial_rx_buffer_head] = data;
+  serial_rx_buffer_head = next_head;
+
+  // Realtime commands never reach this point, so they are exempt from flow control.
+  #ifdef SERIAL_FLOW_CONTROL
+    if ((serial_flow_state == FLOW_STATE_RESUMED) && (serial_get_rx_buffer_count() >= RX_BUFFER_FLOW_HIGH)) {
+      serial_flow_stop();
+    }
+  #endif
+  return(true);
+}
+
+
+#ifdef ENABLE_RX_LINE_ASSEMBLY
+  // Discards the line being received and flags it to be reported as an overflow at its end.
+  static void serial_rx_drop_line()
+  {
+    serial_rx_buffer_head = serial_rx_line_start;
+    serial_rx_line_length = 0;
+    serial_rx_line_flags = RX_LINE_FLAG_OVERFLOW;
+  }
+
+
+  // Terminates the line being received in place. Overflowed lines are replaced by a single
+  // SERIAL_LINE_OVERFLOW character, so the main program can report them.
+  static void serial_rx_end_line()
+  {
+    uint8_t stored;
+    if (serial_rx_line_flags & RX_LINE_FLAG_OVERFLOW) {
+      stored = serial_rx_store(SERIAL_LINE_OVERFLOW) && serial_rx_store(0);
+    } else {
+      stored = serial_rx_store(0);
+    }
+    if (stored) {
+      serial_rx_line_count++;
+      serial_rx_line_start = serial_rx_buffer_head;
+      serial_rx_line_length = 0;
+      serial_rx_line_flags = 0;
+    } else {
+      serial_rx_drop_line(); // Buffer full. Report with the next end of line.
+    }
+  }
+#endif
+
+
 ISR(SERIAL_RX)
 {
+  uint8_t status = UCSR0A; // Must be read before UDR0 to catch a data overrun.
   uint8_t data = UDR0;
-  uint8_t next_head;
+
+  if (status & (1 << DOR0)) { serial_rx_overrun_count++; }
+
+  uint8_t rx_class = pgm_read_byte(&serial_rx_class[data]);
+
+  #ifdef ENABLE_RX_LINE_ASSEMBLY
+    // Perform the initial filtering of the line as it is received, by removing spaces and comments
+    // and capitalizing all letters. Realtime commands are still picked off in comments.
+    if (rx_class >= RX_CLASS_FILTER) {
+      if (rx_class == RX_CLASS_EOL) { serial_rx_end_line(); return; }
+      if (serial_rx_line_flags) {
+        // Throw away all (except EOL) comment characters and overflow characters.
+        if (rx_class == RX_CLASS_COMMENT_CLOSE) { serial_rx_line_flags &= ~(RX_LINE_FLAG_COMMENT_PARENTHESES); }
+        return;
+      }
+      switch (rx_class) {
+        case RX_CLASS_SKIP: return;
+        case RX_CLASS_COMMENT_OPEN: serial_rx_line_flags |= RX_LINE_FLAG_COMMENT_PARENTHESES; return;
+        case RX_CLASS_COMMENT_EOL: serial_rx_line_flags |= RX_LINE_FLAG_COMMENT_SEMICOLON; return;
+        case RX_CLASS_LOWERCASE: data -= 'a'-'A'; break; // Upcase lowercase
+        // A stray ')' outside of a comment is passed on to the parser.
+      }
+      rx_class = RX_CLASS_BUFFER;
+    } else if ((rx_class == RX_CLASS_BUFFER) && serial_rx_line_flags) {
+      return;
+    }
+  #endif
+
+  // Fast path. Write any non-realtime character directly to the buffer.
+  if (rx_class == RX_CLASS_BUFFER) {
+    #ifdef ENABLE_RX_LINE_ASSEMBLY
+      // Detect line overflow, either by length or by a full buffer, and drop the line.
+      // NOTE: The length is also capped by the buffer size, so a full buffer always holds a
+      // complete line for the main program to consume.
+      if ((serial_rx_line_length >= (LINE_BUFFER_SIZE-1)) || (serial_rx_line_length >= (RX_BUFFER_SIZE-2)) ||
+          !serial_rx_store(data)) {
+        serial_rx_drop_line();
+      } else {
+        serial_rx_line_length++;
+      }
+    #else
+      serial_rx_store(data); // Write data to buffer unless it is full.
+    #endif
+    return;
+  }
 
   // Pick off realtime command characters directly from the serial stream. These characters are
   // not passed into the main buffer, but these set system state flag bits for realtime execution.
-  switch (data) {
-    case CMD_RESET:         mc_reset(); break; // Call motion control reset routine.
-    case CMD_STATUS_REPORT: system_set_exec_state_flag(EXEC_STATUS_REPORT); break; // Set as true
-    case CMD_CYCLE_START:   system_set_exec_state_flag(EXEC_CYCLE_START); break; // Set as true
-    case CMD_FEED_HOLD:     system_set_exec_state_flag(EXEC_FEED_HOLD); break; // Set as true
-    default :
-      if (data > 0x7F) { // Real-time control characters are extended ACSII only.
-        switch(data) {
-          case CMD_SAFETY_DOOR:   system_set_exec_state_flag(EXEC_SAFETY_DOOR); break; // Set as true
-          case CMD_JOG_CANCEL:
-            if (sys.state & STATE_JOG) { // Block all other states from invoking motion cancel.
-              system_set_exec_state_flag(EXEC_MOTION_CANCEL);
-              serial_reset_read_buffer(); // Vide un reste éventuel de données dans le buffer
-            }
-            break;
-          #ifdef DEBUG
-            case CMD_DEBUG_REPORT: {uint8_t sreg = SREG; cli(); bit_true(sys_rt_exec_debug,EXEC_DEBUG_REPORT); SREG = sreg;} break;
-          #endif
-          case CMD_FEED_OVR_RESET: system_set_exec_motion_override_flag(EXEC_FEED_OVR_RESET); break;
-          case CMD_FEED_OVR_COARSE_PLUS: system_set_exec_motion_override_flag(EXEC_FEED_OVR_COARSE_PLUS); break;
-          case CMD_FEED_OVR_COARSE_MINUS: system_set_exec_motion_override_flag(EXEC_FEED_OVR_COARSE_MINUS); break;
-          case CMD_FEED_OVR_FINE_PLUS: system_set_exec_motion_override_flag(EXEC_FEED_OVR_FINE_PLUS); break;
-          case CMD_FEED_OVR_FINE_MINUS: system_set_exec_motion_override_flag(EXEC_FEED_OVR_FINE_MINUS); break;
-          case CMD_RAPID_OVR_RESET: system_set_exec_motion_override_flag(EXEC_RAPID_OVR_RESET); break;
-          case CMD_RAPID_OVR_MEDIUM: system_set_exec_motion_override_flag(EXEC_RAPID_OVR_MEDIUM); break;
-          case CMD_RAPID_OVR_LOW: system_set_exec_motion_override_flag(EXEC_RAPID_OVR_LOW); break;
-          case CMD_SPINDLE_OVR_RESET: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_RESET); break;
-          case CMD_SPINDLE_OVR_COARSE_PLUS: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_COARSE_PLUS); break;
-          case CMD_SPINDLE_OVR_COARSE_MINUS: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_COARSE_MINUS); break;
-          case CMD_SPINDLE_OVR_FINE_PLUS: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_FINE_PLUS); break;
-          case CMD_SPINDLE_OVR_FINE_MINUS: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_FINE_MINUS); break;
-          case CMD_SPINDLE_OVR_STOP: system_set_exec_accessory_override_flag(EXEC_SPINDLE_OVR_STOP); break;
-          case CMD_COOLANT_FLOOD_OVR_TOGGLE: system_set_exec_accessory_override_flag(EXEC_COOLANT_FLOOD_OVR_TOGGLE); break;
-          case CMD_COOLANT_MIST_OVR_TOGGLE: system_set_exec_accessory_override_flag(EXEC_COOLANT_MIST_OVR_TOGGLE); break;
-        }
-        // Throw away any unfound extended-ASCII character by not passing it to the serial buffer.
-      } else { // Write character to buffer
-        next_head = serial_rx_buffer_head + 1;
-        if (next_head == RX_RING_BUFFER) { next_head = 0; }
-
-        // Write data to buffer unless it is full.
-        if (next_head != serial_rx_buffer_tail) {
-          serial_rx_buffer[serial_rx_buffer_head] = data;
-          serial_rx_buffer_head = next_head;
-        }
+  uint8_t flag = bit(rx_class & 0x07);
+  switch (rx_class & RX_CLASS_MASK) {
+    case RX_CLASS_EXEC_STATE: system_set_exec_state_flag(flag); break; // Set as true
+    case RX_CLASS_EXEC_MOTION: system_set_exec_motion_override_flag(flag); break;
+    case RX_CLASS_EXEC_ACCESSORY: system_set_exec_accessory_override_flag(flag); break;
+    case RX_CLASS_RESET: mc_reset(); break; // Call motion control reset routine.
+    case RX_CLASS_JOG_CANCEL:
+      if (sys.state & STATE_JOG) { // Block all other states from invoking motion cancel.
+        system_set_exec_state_flag(EXEC_MOTION_CANCEL);
+        serial_reset_read_buffer(); // Vide un reste éventuel de données dans le buffer
       }
+      break;
+    #ifdef DEBUG
+      case RX_CLASS_DEBUG_REPORT: {uint8_t sreg = SREG; cli(); bit_true(sys_rt_exec_debug,EXEC_DEBUG_REPORT); SREG = sreg;} break;
+    #endif
+    // Throw away any unfound extended-ASCII character by not passing it to the serial buffer.
   }
 }
 
 
+// Returns the number of UART hardware data overruns since power-up. Wraps at 65536.
+uint16_t serial_get_rx_overrun_count()
+{
+  uint8_t sreg = SREG;
+  cli();
+  uint16_t count = serial_rx_overrun_count;
+  SREG = sreg;
+  return(count);
+}
+
+
+#ifdef ENABLE_RX_LINE_ASSEMBLY
+  // Returns the next complete and pre-filtered line in the RX buffer, or NULL, if there is none.
+  // Lines are zero-terminated in the ring buffer by the RX interrupt and normally returned in
+  // place, without any copying. Only lines wrapping around the end of the ring and '$' system
+  // commands, which may rewrite their line, are copied into the supplied line buffer.
+  // NOTE: The line must be released with serial_release_line() after execution.
+  char *serial_get_line(char *line)
+  {
+    if (serial_rx_line_count == 0) { return(NULL); }
+
+    uint8_t tail = serial_rx_buffer_tail;
+    uint8_t end = tail;
+    while (serial_rx_buffer[end] != 0) {
+      end++;
+      if (end == RX_RING_BUFFER) { end = 0; }
+    }
+    serial_rx_line_end = end;
+    serial_rx_line_held = true;
+
+    if (end >= tail) {
+      if (serial_rx_buffer[tail] != '$') { return((char*)&serial_rx_buffer[tail]); }
+      memcpy(line, &serial_rx_buffer[tail], end-tail+1);
+    } else {
+      uint8_t n = RX_RING_BUFFER-tail;
+      memcpy(line, &serial_rx_buffer[tail], n);
+      memcpy(line+n, serial_rx_buffer, end+1);
+    }
+    return(line);
+  }
+
+
+  // Frees the line returned by serial_get_line() from the RX buffer. Does nothing, if the buffer
+  // has been reset in the meantime.
+  void serial_release_line()
+  {
+    uint8_t sreg = SREG;
+    cli();
+    if (serial_rx_line_held) {
+      uint8_t tail = serial_rx_line_end+1;
+      if (tail == RX_RING_BUFFER) { tail = 0; }
+      serial_rx_buffer_tail = tail;
+      serial_rx_line_count--;
+      serial_rx_line_held = false;
+    }
+    SREG = sreg;
+
+    #ifdef SERIAL_FLOW_CONTROL
+      if ((serial_flow_state == FLOW_STATE_STOPPED) && (serial_get_rx_buffer_count() < RX_BUFFER_FLOW_LOW)) {
+        serial_flow_resume();
+      }
+    #endif
+  }
+#endif
+
+
 void serial_reset_read_buffer()
 {
-  serial_rx_buffer_tail = serial_rx_buffer_head;
+  #ifdef ENABLE_RX_LINE_ASSEMBLY
+    uint8_t sreg = SREG;
+    cli();
+    serial_rx_buffer_tail = serial_rx_buffer_head;
+    serial_rx_line_start = serial_rx_buffer_head;
+    serial_rx_line_length = 0;
+    serial_rx_line_flags = 0;
+    serial_rx_line_count = 0;
+    serial_rx_line_held = false;
+    SREG = sreg;
+  #else
+    serial_rx_buffer_tail = serial_rx_buffer_head;
+  #endif
+
+  #ifdef SERIAL_FLOW_CONTROL
+    if (serial_flow_state != FLOW_STATE_RESUMED) { serial_flow_resume(); }
+  #endif
 }
 
 
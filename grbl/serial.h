@@ -31,6 +31,27 @@
 #endif
 
 #define SERIAL_NO_DATA 0xff
+#define SERIAL_LINE_OVERFLOW 0x01 // Replaces the content of an overflowed line. See serial_get_line().
+
+#if defined(ENABLE_XONXOFF) || defined(ENABLE_RTS_FLOW_CONTROL)
+  #define SERIAL_FLOW_CONTROL
+  // Receive buffer watermarks. Stop is signaled at the high mark and resume below the low mark.
+  #ifndef RX_BUFFER_FLOW_HIGH
+    #define RX_BUFFER_FLOW_HIGH (RX_BUFFER_SIZE-64)
+  #endif
+  #ifndef RX_BUFFER_FLOW_LOW
+    #define RX_BUFFER_FLOW_LOW (RX_BUFFER_SIZE-128)
+  #endif
+
+  // Flow control states.
+  #define FLOW_STATE_RESUMED      0 // Host allowed to send. XON sent or RTS asserted.
+  #define FLOW_STATE_SEND_STOP    1 // XOFF queued ahead of the TX ring.
+  #define FLOW_STATE_STOPPED      2 // Host halted. XOFF sent or RTS de-asserted.
+  #define FLOW_STATE_SEND_RESUME  3 // XON queued ahead of the TX ring.
+
+  #define XON_CHAR  0x11
+  #define XOFF_CHAR 0x13
+#endif
 
 
 void serial_init();
@@ -38,12 +59,29 @@ void serial_init();
 // Writes one byte to the TX serial buffer. Called by main program.
 void serial_write(uint8_t data);
 
+// Writes a block of bytes to the TX serial buffer. Called by main program.
+void serial_write_buffer(const uint8_t *data, uint8_t length);
+
+// Reserves room for length bytes in the TX serial buffer, which are then stored without checks by
+// serial_write_reserved() and sent by serial_write_commit(). Returns false, if aborted by a reset.
+uint8_t serial_write_reserve(uint8_t length);
+void serial_write_reserved(uint8_t data);
+void serial_write_commit();
+
 // Write à string to the TX serial buffer. (for debugging)
 void serial_putstring(char* StringPtr);
 
 // Fetches the first byte in the serial read buffer. Called by main program.
 uint8_t serial_read();
 
+#ifdef ENABLE_RX_LINE_ASSEMBLY
+  // Returns the next complete, pre-filtered line in the read buffer or NULL. Called by main program.
+  char *serial_get_line(char *line);
+
+  // Frees the line returned by serial_get_line() from the read buffer.
+  void serial_release_line();
+#endif
+
 // Reset and empty data in read buffer. Used by e-stop and reset.
 void serial_reset_read_buffer();
 
@@ -51,11 +89,17 @@ void serial_reset_read_buffer();
 uint8_t serial_get_rx_buffer_available();
 
 // Returns the number of bytes used in the RX serial buffer.
-// NOTE: Deprecated. Not used unless classic status reports are enabled in config.h.
+// NOTE: Only used by the serial flow control options in config.h.
 uint8_t serial_get_rx_buffer_count();
 
+// Returns the number of UART hardware data overruns since power-up.
+uint16_t serial_get_rx_overrun_count();
+
 // Returns the number of bytes used in the TX serial buffer.
 // NOTE: Not used except for debugging and ensuring no TX bottlenecks.
 uint8_t serial_get_tx_buffer_count();
 
+// Returns the number of bytes available in the TX serial buffer.
+uint8_t serial_get_tx_buffer_available();
+
 #endif
@@ -56,6 +56,16 @@ void settings_write_coord_data(uint8_t coord_select, float *coord_data)
 }
 
 
+#ifdef ENABLE_JOB_CHECKPOINT
+  // Method to store the job checkpoint into EEPROM. Only the changed bytes are written.
+  // NOTE: Called with the steppers idle, at the end of a cycle or after a reset.
+  void settings_write_checkpoint(int32_t *checkpoint_data)
+  {
+    memcpy_to_eeprom_with_checksum(EEPROM_ADDR_CHECKPOINT,(char*)checkpoint_data, sizeof(int32_t)*(N_AXIS+1));
+  }
+#endif
+
+
 // Method to store Grbl global settings struct and version number into EEPROM
 // NOTE: This function can only be called in IDLE state.
 void write_global_settings()
@@ -74,6 +84,8 @@ void settings_restore(uint8_t restore_flag) {
     settings.dir_invert_mask = DEFAULT_DIRECTION_INVERT_MASK;
     settings.status_report_mask = DEFAULT_STATUS_REPORT_MASK;
     settings.junction_deviation = DEFAULT_JUNCTION_DEVIATION;
+    settings.rotary_junction_deviation = DEFAULT_ROTARY_JUNCTION_DEVIATION;
+    settings.rotary_wrap_mask = DEFAULT_ROTARY_WRAP_MASK;
     settings.arc_tolerance = DEFAULT_ARC_TOLERANCE;
 
     settings.rpm_max = DEFAULT_SPINDLE_RPM_MAX;
@@ -139,6 +151,7 @@ void settings_restore(uint8_t restore_flag) {
     #endif
 
     write_global_settings();
+    print_update_coord_scale();
   }
 
   if (restore_flag & SETTINGS_RESTORE_PARAMETERS) {
@@ -207,6 +220,21 @@ uint8_t settings_read_coord_data(uint8_t coord_select, float *coord_data)
 }
 
 
+#ifdef ENABLE_JOB_CHECKPOINT
+  // Read the job checkpoint from EEPROM. Updates pointed checkpoint_data value.
+  uint8_t settings_read_checkpoint(int32_t *checkpoint_data)
+  {
+    if (!(memcpy_from_eeprom_with_checksum((char*)checkpoint_data, EEPROM_ADDR_CHECKPOINT, sizeof(int32_t)*(N_AXIS+1)))) {
+      // Reset with no checkpoint
+      memset(checkpoint_data, 0, sizeof(int32_t)*(N_AXIS+1));
+      settings_write_checkpoint(checkpoint_data);
+      return(false);
+    }
+    return(true);
+  }
+#endif
+
+
 // Reads Grbl global settings struct from EEPROM.
 uint8_t read_global_settings() {
   // Check version-byte of eeprom
@@ -251,7 +279,11 @@ uint8_t settings_store_global_setting(uint8_t parameter, float value) {
           case 3: settings.max_travel[parameter] = -value; break;  // Store as negative for grbl internal use.
           case 4:
             settings.current[parameter] = value;
-            set_current(parameter, settings.current[parameter]);
+            #ifdef MOTOR_CURRENT_PROFILES
+              current_load_profiles(); // Rescale all phases of the new run current.
+            #else
+              set_current(parameter, settings.current[parameter]);
+            #endif
             break;
           case 5:
             settings.endstop_adj[parameter] = value;
@@ -302,6 +334,12 @@ uint8_t settings_store_global_setting(uint8_t parameter, float value) {
         else { settings.flags &= ~BITFLAG_REPORT_INCHES; }
         system_flag_wco_change(); // Make sure WCO is immediately updated.
         break;
+      case 14: settings.rotary_junction_deviation = value; break;
+      case 15:
+        // Only rotary axes wrap. A linear axis would wrap at 360mm and lose its soft limits.
+        if (int_value & ~(axis_A_mask | axis_B_mask | axis_C_mask)) { return(STATUS_INVALID_STATEMENT); }
+        settings.rotary_wrap_mask = int_value;
+        break;
       case 20:
         if (int_value) {
           if (bit_isfalse(settings.flags, BITFLAG_HOMING_ENABLE)) { return(STATUS_SOFT_LIMIT_ERROR); }
@@ -336,6 +374,7 @@ uint8_t settings_store_global_setting(uint8_t parameter, float value) {
     }
   }
   write_global_settings();
+  print_update_coord_scale(); // Steps/mm or report units may have changed.
   return(STATUS_OK);
 }
 
@@ -345,8 +384,9 @@ void settings_init() {
   if(!read_global_settings()) {
     report_status_message(STATUS_SETTING_READ_FAIL);
     settings_restore(SETTINGS_RESTORE_ALL); // Force restore all EEPROM data.
-    report_grbl_settings();
+    report_start(REPORT_SETTINGS); // Finished by the main loop.
   }
+  print_update_coord_scale();
 }
 
 
@@ -31,7 +31,7 @@
 
 // Version of the EEPROM data. Will be used to migrate existing data from older versions of Grbl
 // when firmware is upgraded. Always stored in byte 0 of eeprom
-#define SETTINGS_VERSION 10  // NOTE: Check settings_reset() when moving to next version.
+#define SETTINGS_VERSION 11  // NOTE: Check settings_reset() when moving to next version.
 
 // Define bit flag masks for the boolean settings in settings.flag.
 #define BITFLAG_REPORT_INCHES      bit(0)
@@ -61,6 +61,7 @@
 #define EEPROM_ADDR_PARAMETERS     512U
 #define EEPROM_ADDR_STARTUP_BLOCK  768U
 #define EEPROM_ADDR_BUILD_INFO     942U
+#define EEPROM_ADDR_CHECKPOINT     2048U // Job checkpoint. Past the build info, in the free upper EEPROM.
 
 // Define EEPROM address indexing for coordinate parameters
 #define N_COORDINATE_SYSTEM 6  // Number of supported work coordinate systems (from index 1)
@@ -92,6 +93,8 @@ typedef struct {
   uint8_t stepper_idle_lock_time; // If max value 255, steppers do not disable.
   uint8_t status_report_mask; // Mask to indicate desired report data.
   float junction_deviation;
+  float rotary_junction_deviation; // Junction deviation of the A, B and C axes in degrees.
+  uint8_t rotary_wrap_mask; // Rotary axes whose position wraps at 360 degrees.
   float arc_tolerance;
 
   float rpm_max;
@@ -134,6 +137,12 @@ void settings_write_coord_data(uint8_t coord_select, float *coord_data);
 // Reads selected coordinate data from EEPROM
 uint8_t settings_read_coord_data(uint8_t coord_select, float *coord_data);
 
+// Writes the job checkpoint line number, followed by its position, to EEPROM
+void settings_write_checkpoint(int32_t *checkpoint_data);
+
+// Reads the job checkpoint line number and position from EEPROM
+uint8_t settings_read_checkpoint(int32_t *checkpoint_data);
+
 // Returns the step pin mask according to Grbl's internal axis numbering
 uint8_t get_step_pin_mask(uint8_t i);
 
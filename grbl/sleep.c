@@ -31,6 +31,9 @@ volatile uint8_t sleep_counter;
 static void sleep_enable() { 
   sleep_counter = 0; // Reset sleep counter
   TCNT3 = 0;  // Reset timer3 counter register
+  #ifdef ENABLE_PERFORMANCE_COUNTERS
+    perf_skip_main_loop_sample(); // Main loop timing shares timer3.
+  #endif
   TIMSK3 |= (1<<TOIE3); // Enable timer3 overflow interrupt
 } 
 
@@ -22,7 +22,39 @@
 #include "grbl.h"
 
 
-static float pwm_gradient; // Precalulated value to speed up rpm to PWM conversions.
+// RPM to PWM lookup table. The entries are the PWM values of evenly spaced speeds across the
+// operating range of the spindle model, so a segment update only interpolates between two of them.
+#define PWM_TABLE_FRACT_BITS 4 // Fractional bits of the table entries. Leaves 12 bits for the PWM value.
+
+typedef struct {
+  uint16_t pwm[SPINDLE_PWM_TABLE_SIZE]; // PWM values in 12.4 fixed point.
+  float rpm_min;          // Actual rpm of the first and last entries.
+  float rpm_max;
+  float programmed_min;   // Programmed rpm of the first and last entries at the current override.
+  float programmed_max;
+  float ovr_scale;        // Actual rpm per programmed rpm.
+  float index_scale;      // Table index per programmed rpm in 16.16 fixed point.
+} spindle_pwm_table_t;
+static spindle_pwm_table_t pwm_table;
+
+#ifdef SPINDLE_PWM_CURVE
+  static const float pwm_curve[] = { SPINDLE_PWM_CURVE };
+  #define PWM_CURVE_POINTS (sizeof(pwm_curve)/sizeof(float))
+#endif
+
+#ifdef SPINDLE_AT_SPEED
+  // Tachometer pulses are timed by the input capture unit of a free running timer, which is extended
+  // to 32 bits by counting its overflows. The speed is measured over a whole revolution, so uneven
+  // spacing of the pulses around the spindle cancels out.
+  #define TACH_STOP_OVERFLOWS (SPINDLE_TACH_TICKS_PER_SECOND/65536UL) // One second without a pulse.
+  #define TACH_NO_REVOLUTION 0xff // Pulse count until the first pulse after a stop.
+
+  static volatile uint16_t tach_overflows;      // Timer overflows. Upper word of the capture times.
+  static volatile uint8_t tach_idle_overflows;  // Timer overflows since the last pulse.
+  static volatile uint8_t tach_pulse_count;     // Pulses of the current revolution.
+  static volatile uint32_t tach_rev_start;      // Capture time of the first pulse of the revolution.
+  static volatile uint32_t tach_rev_period;     // Timer ticks of the last revolution. Zero, if stopped.
+#endif
 
 
 void spindle_init()
@@ -35,8 +67,22 @@ void spindle_init()
   SPINDLE_ENABLE_DDR |= (1<<SPINDLE_ENABLE_BIT); // Configure as output pin.
   SPINDLE_DIRECTION_DDR |= (1<<SPINDLE_DIRECTION_BIT); // Configure as output pin.
 
-  pwm_gradient = SPINDLE_PWM_RANGE/(settings.rpm_max-settings.rpm_min);
+  spindle_update_pwm_table();
   spindle_stop();
+
+  #ifdef SPINDLE_AT_SPEED
+    // Configure the tachometer input and let its timer run free with input capture.
+    SPINDLE_TACH_DDR &= ~(1<<SPINDLE_TACH_BIT); // Configure as input pin.
+    SPINDLE_TACH_PORT |= (1<<SPINDLE_TACH_BIT); // Enable internal pull-up resistor for open collector sensors.
+    SPINDLE_TACH_TIMSK_REGISTER = 0;
+    tach_idle_overflows = 0;
+    tach_pulse_count = TACH_NO_REVOLUTION;
+    tach_rev_period = 0;
+    SPINDLE_TACH_TCCRA_REGISTER = 0;
+    SPINDLE_TACH_TCCRB_REGISTER = SPINDLE_TACH_TCCRB_INIT_MASK;
+    SPINDLE_TACH_TIFR_REGISTER = (1<<SPINDLE_TACH_ICF_BIT) | (1<<SPINDLE_TACH_TOV_BIT); // Clear pending flags.
+    SPINDLE_TACH_TIMSK_REGISTER = (1<<SPINDLE_TACH_ICIE_BIT) | (1<<SPINDLE_TACH_TOIE_BIT);
+  #endif
 }
 
 
@@ -94,79 +140,115 @@ void spindle_set_speed(uint16_t pwm_value)
 }
 
 
-#ifdef ENABLE_PIECEWISE_LINEAR_SPINDLE
-
-  // Called by spindle_set_state() and step segment generator. Keep routine small and efficient.
-  uint16_t spindle_compute_pwm_value(float rpm) // 328p PWM register is 8-bit.
-  {
-    uint16_t pwm_value;
-    rpm *= (0.010*sys.spindle_speed_ovr); // Scale by spindle speed override value.
-    // Calculate PWM register value based on rpm max/min settings and programmed rpm.
-    if ((settings.rpm_min >= settings.rpm_max) || (rpm >= RPM_MAX)) {
-      rpm = RPM_MAX;
-      pwm_value = SPINDLE_PWM_MAX_VALUE;
-    } else if (rpm <= RPM_MIN) {
-      if (rpm == 0.0) { // S0 disables spindle
-        pwm_value = SPINDLE_PWM_OFF_VALUE;
-      } else {
-        rpm = RPM_MIN;
-        pwm_value = SPINDLE_PWM_MIN_VALUE;
-      }
-    } else {
-      // Compute intermediate PWM value with linear spindle speed model via piecewise linear fit model.
-      #if (N_PIECES > 3)
-        if (rpm > RPM_POINT34) {
-          pwm_value = floor(RPM_LINE_A4*rpm - RPM_LINE_B4);
-        } else 
-      #endif
-      #if (N_PIECES > 2)
-        if (rpm > RPM_POINT23) {
-          pwm_value = floor(RPM_LINE_A3*rpm - RPM_LINE_B3);
-        } else 
-      #endif
-      #if (N_PIECES > 1)
-        if (rpm > RPM_POINT12) {
-          pwm_value = floor(RPM_LINE_A2*rpm - RPM_LINE_B2);
-        } else 
-      #endif
-      {
-        pwm_value = floor(RPM_LINE_A1*rpm - RPM_LINE_B1);
-      }
+// Returns the PWM value of the spindle model at an rpm within its operating range. Only used to
+// build the lookup table, so it doesn't need to be fast.
+static float spindle_model_pwm_value(float rpm)
+{
+  #if defined(SPINDLE_PWM_CURVE)
+    // Interpolate between the measured speeds, which are spaced evenly in PWM.
+    uint8_t idx = 1;
+    while ((idx < PWM_CURVE_POINTS-1) && (rpm > pwm_curve[idx])) { idx++; }
+    float position = (idx-1) + (rpm-pwm_curve[idx-1])/(pwm_curve[idx]-pwm_curve[idx-1]);
+    return(SPINDLE_PWM_MIN_VALUE + position*(SPINDLE_PWM_RANGE/(PWM_CURVE_POINTS-1)));
+  #elif defined(ENABLE_PIECEWISE_LINEAR_SPINDLE)
+    // Piecewise linear fit model given by the 'fit_nonlinear_spindle.py' script solution.
+    #if (N_PIECES > 3)
+      if (rpm > RPM_POINT34) { return(RPM_LINE_A4*rpm - RPM_LINE_B4); }
+    #endif
+    #if (N_PIECES > 2)
+      if (rpm > RPM_POINT23) { return(RPM_LINE_A3*rpm - RPM_LINE_B3); }
+    #endif
+    #if (N_PIECES > 1)
+      if (rpm > RPM_POINT12) { return(RPM_LINE_A2*rpm - RPM_LINE_B2); }
+    #endif
+    return(RPM_LINE_A1*rpm - RPM_LINE_B1);
+  #else
+    // Linear spindle speed model between the rpm max/min settings.
+    return(SPINDLE_PWM_MIN_VALUE + (rpm-settings.rpm_min)*(SPINDLE_PWM_RANGE/(settings.rpm_max-settings.rpm_min)));
+  #endif
+}
+
+
+// Rebuilds the lookup table from the spindle model and the rpm max/min settings.
+void spindle_update_pwm_table()
+{
+  // The operating range is limited to the range of the model, if it has one.
+  float rpm_min = settings.rpm_min;
+  float rpm_max = settings.rpm_max;
+  #if defined(SPINDLE_PWM_CURVE)
+    rpm_min = max(rpm_min,pwm_curve[0]);
+    rpm_max = min(rpm_max,pwm_curve[PWM_CURVE_POINTS-1]);
+  #elif defined(ENABLE_PIECEWISE_LINEAR_SPINDLE)
+    rpm_min = max(rpm_min,RPM_MIN);
+    rpm_max = min(rpm_max,RPM_MAX);
+  #endif
+  pwm_table.rpm_min = rpm_min;
+  pwm_table.rpm_max = rpm_max;
+
+  uint16_t idx;
+  if (rpm_min >= rpm_max) {
+    // No PWM range possible. Set simple on/off spindle control pin state.
+    for (idx=0; idx<SPINDLE_PWM_TABLE_SIZE; idx++) {
+      pwm_table.pwm[idx] = (uint16_t)SPINDLE_PWM_MAX_VALUE << PWM_TABLE_FRACT_BITS;
+    }
+  } else {
+    float rpm_step = (rpm_max-rpm_min)/(SPINDLE_PWM_TABLE_SIZE-1);
+    for (idx=0; idx<SPINDLE_PWM_TABLE_SIZE; idx++) {
+      float pwm_value = spindle_model_pwm_value(rpm_min+idx*rpm_step);
+      pwm_value = max(pwm_value,SPINDLE_PWM_MIN_VALUE);
+      pwm_value = min(pwm_value,SPINDLE_PWM_MAX_VALUE);
+      pwm_table.pwm[idx] = pwm_value*(1<<PWM_TABLE_FRACT_BITS);
     }
-    sys.spindle_speed = rpm;
-    return(pwm_value);
   }
+  spindle_update_pwm_override();
+}
+
+
+// Rescales the programmed rpm range of the lookup table by the spindle speed override. Cheap
+// enough for the realtime override commands, since the table entries themselves don't change.
+void spindle_update_pwm_override()
+{
+  pwm_table.ovr_scale = 0.010*sys.spindle_speed_ovr;
+  pwm_table.programmed_min = pwm_table.rpm_min/pwm_table.ovr_scale;
+  pwm_table.programmed_max = pwm_table.rpm_max/pwm_table.ovr_scale;
+  if (pwm_table.rpm_min < pwm_table.rpm_max) {
+    pwm_table.index_scale = (65536.0*(SPINDLE_PWM_TABLE_SIZE-1))*pwm_table.ovr_scale/(pwm_table.rpm_max-pwm_table.rpm_min);
+  }
+}
 
-#else 
-
-  // Called by spindle_set_state() and step segment generator. Keep routine small and efficient.
-  uint16_t spindle_compute_pwm_value(float rpm) // Mega2560 PWM register is 16-bit.
-  {
-	uint16_t pwm_value;
-	rpm *= (0.010*sys.spindle_speed_ovr); // Scale by spindle speed override value.
-	// Calculate PWM register value based on rpm max/min settings and programmed rpm.
-	if ((settings.rpm_min >= settings.rpm_max) || (rpm >= settings.rpm_max)) {
-	  // No PWM range possible. Set simple on/off spindle control pin state.
-	  sys.spindle_speed = settings.rpm_max;
-	  pwm_value = SPINDLE_PWM_MAX_VALUE;
-	} else if (rpm <= settings.rpm_min) {
-	  if (rpm == 0.0) { // S0 disables spindle
-		sys.spindle_speed = 0.0;
-		pwm_value = SPINDLE_PWM_OFF_VALUE;
-	  } else { // Set minimum PWM output
-		sys.spindle_speed = settings.rpm_min;
-		pwm_value = SPINDLE_PWM_MIN_VALUE;
-	  }
-	} else { 
-	  // Compute intermediate PWM value with linear spindle speed model.
-	  // NOTE: A nonlinear model could be installed here, if required, but keep it VERY light-weight.
-	  sys.spindle_speed = rpm;
-	  pwm_value = floor((rpm-settings.rpm_min)*pwm_gradient) + SPINDLE_PWM_MIN_VALUE;
-	}
-	return(pwm_value);
+
+// Called by spindle_set_state() and step segment generator. Keep routine small and efficient.
+uint16_t spindle_compute_pwm_value(float rpm) // Mega2560 PWM register is 16-bit.
+{
+  uint16_t pwm_value;
+  // Compare the programmed rpm to the range of the table, which already includes the override.
+  if ((pwm_table.rpm_min >= pwm_table.rpm_max) || (rpm >= pwm_table.programmed_max)) {
+    sys.spindle_speed = pwm_table.rpm_max;
+    pwm_value = pwm_table.pwm[SPINDLE_PWM_TABLE_SIZE-1] >> PWM_TABLE_FRACT_BITS;
+  } else if (rpm <= pwm_table.programmed_min) {
+    if (rpm == 0.0) { // S0 disables spindle
+      sys.spindle_speed = 0.0;
+      pwm_value = SPINDLE_PWM_OFF_VALUE;
+    } else { // Set minimum PWM output
+      sys.spindle_speed = pwm_table.rpm_min;
+      pwm_value = pwm_table.pwm[0] >> PWM_TABLE_FRACT_BITS;
+    }
+  } else {
+    // Interpolate between the two table entries around the rpm.
+    sys.spindle_speed = rpm*pwm_table.ovr_scale;
+    uint32_t position = (rpm-pwm_table.programmed_min)*pwm_table.index_scale;
+    uint16_t idx = position >> 16;
+    if (idx >= SPINDLE_PWM_TABLE_SIZE-1) {
+      pwm_value = pwm_table.pwm[SPINDLE_PWM_TABLE_SIZE-1];
+    } else {
+      int32_t pwm_delta = (int32_t)pwm_table.pwm[idx+1] - pwm_table.pwm[idx];
+      pwm_value = pwm_table.pwm[idx] + ((pwm_delta*(uint16_t)position) >> 16);
+    }
+    pwm_value >>= PWM_TABLE_FRACT_BITS;
   }
+  return(pwm_value);
+}
 
-#endif  
 
 // Immediately sets spindle running state with direction and spindle rpm via PWM, if enabled.
 // Called by g-code parser spindle_sync(), parking retract and restore, g-code program end,
@@ -207,6 +289,83 @@ void spindle_set_state(uint8_t state, float rpm)
 }
 
 
+#ifdef SPINDLE_AT_SPEED
+
+// Times a tachometer pulse and completes the revolution measurement on its last pulse.
+ISR(SPINDLE_TACH_CAPT_vect)
+{
+  uint16_t capture = SPINDLE_TACH_ICR_REGISTER;
+  uint16_t overflows = tach_overflows;
+  // A pending overflow happened before the capture, if the capture is from the start of the count.
+  if ((SPINDLE_TACH_TIFR_REGISTER & (1<<SPINDLE_TACH_TOV_BIT)) && (capture < 0x8000)) { overflows++; }
+  uint32_t capture_time = ((uint32_t)overflows << 16) | capture;
+
+  tach_idle_overflows = 0;
+  if (tach_pulse_count == TACH_NO_REVOLUTION) {
+    tach_pulse_count = 0;
+    tach_rev_start = capture_time;
+  } else if (++tach_pulse_count == SPINDLE_TACH_PULSES_PER_REV) {
+    tach_pulse_count = 0;
+    tach_rev_period = capture_time - tach_rev_start;
+    tach_rev_start = capture_time;
+  }
+}
+
+
+// Extends the timer and marks the spindle as stopped, when the pulses stop.
+ISR(SPINDLE_TACH_OVF_vect)
+{
+  tach_overflows++;
+  if (tach_idle_overflows < TACH_STOP_OVERFLOWS) {
+    tach_idle_overflows++;
+  } else {
+    tach_pulse_count = TACH_NO_REVOLUTION;
+    tach_rev_period = 0;
+  }
+}
+
+
+// Returns the measured spindle speed in rpm.
+float spindle_get_rpm()
+{
+  uint8_t sreg = SREG;
+  cli();
+  uint32_t rev_period = tach_rev_period;
+  SREG = sreg;
+  if (rev_period == 0) { return(0.0); }
+  return((60.0*SPINDLE_TACH_TICKS_PER_SECOND)/rev_period);
+}
+
+
+// Waits for the spindle to reach SPINDLE_AT_SPEED_PERCENT of the programmed speed in sys.spindle_speed.
+// Executes realtime commands like a dwell in the given delay mode. Stops the spindle and issues an
+// alarm, if it doesn't reach the speed within SPINDLE_AT_SPEED_TIMEOUT.
+void spindle_wait_at_speed(uint8_t mode)
+{
+  float rpm_at_speed = sys.spindle_speed*(SPINDLE_AT_SPEED_PERCENT/100.0);
+  uint16_t i = ceil(1000/DWELL_TIME_STEP*SPINDLE_AT_SPEED_TIMEOUT);
+  while (spindle_get_rpm() < rpm_at_speed) {
+    if (sys.abort) { return; }
+    if (i-- == 0) {
+      mc_reset(); // Stop the spindle.
+      system_set_exec_alarm(EXEC_ALARM_SPINDLE_AT_SPEED); // Report the cause over a held cycle abort.
+      protocol_exec_rt_system(); // Report the alarm and abort. Doesn't nest suspend loops.
+      return;
+    }
+    if (mode == DELAY_MODE_DWELL) {
+      protocol_execute_realtime();
+    } else { // DELAY_MODE_SYS_SUSPEND
+      // Execute rt_system() only to avoid nesting suspend loops.
+      protocol_exec_rt_system();
+      if (sys.suspend & SUSPEND_RESTART_RETRACT) { return; } // Bail, if safety door reopens.
+    }
+    _delay_ms(DWELL_TIME_STEP); // Delay DWELL_TIME_STEP increment
+  }
+}
+
+#endif
+
+
 // G-code parser entry-point for setting spindle state. Forces a planner buffer sync and bails 
 // if an abort or check-mode is active.
 void spindle_sync(uint8_t state, float rpm)
@@ -214,4 +373,10 @@ void spindle_sync(uint8_t state, float rpm)
   if (sys.state == STATE_CHECK_MODE) { return; }
   protocol_buffer_synchronize(); // Empty planner buffer to ensure spindle is set when programmed.
   spindle_set_state(state,rpm);
+  #ifdef SPINDLE_AT_SPEED
+    // Hold the program until the spindle is up to speed. A laser is at power instantly.
+    if ((state != SPINDLE_DISABLE) && bit_isfalse(settings.flags,BITFLAG_LASER_MODE)) {
+      spindle_wait_at_speed(DELAY_MODE_DWELL);
+    }
+  #endif
 }
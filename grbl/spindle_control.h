@@ -29,6 +29,12 @@
 #define SPINDLE_STATE_CW       bit(0)
 #define SPINDLE_STATE_CCW      bit(1)
 
+// Number of entries in the RPM to PWM lookup table, spaced evenly across the operating range of the
+// spindle model. More entries follow a nonlinear model more closely. Each entry takes 2 bytes of RAM.
+#ifndef SPINDLE_PWM_TABLE_SIZE
+  #define SPINDLE_PWM_TABLE_SIZE 33
+#endif
+
 
 // Initializes spindle pins and hardware PWM, if enabled.
 void spindle_init();
@@ -52,9 +58,21 @@ void spindle_set_speed(uint16_t pwm_value);
 
 // Computes Mega2560-specific PWM register value for the given RPM for quick updating.
 uint16_t spindle_compute_pwm_value(float rpm);
+
+// Rebuilds the RPM to PWM lookup table. Called by spindle_init() when $30 or $31 change.
+void spindle_update_pwm_table();
+
+// Rescales the lookup table input to a new spindle speed override value.
+void spindle_update_pwm_override();
   
 // Stop and start spindle routines. Called by all spindle routines and stepper ISR.
 void spindle_stop();
 
+// Returns the spindle speed measured by the tachometer in rpm. Zero, if stopped.
+float spindle_get_rpm();
+
+// Waits for the spindle to come up to the programmed speed. Issues an alarm, if it doesn't.
+void spindle_wait_at_speed(uint8_t mode);
+
 
 #endif
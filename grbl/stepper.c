@@ -25,6 +25,12 @@
 
 // Some useful constants.
 #define DT_SEGMENT (1.0/(ACCELERATION_TICKS_PER_SECOND*60.0)) // min/segment
+#ifdef SEGMENT_CRUISE_TIME_SCALE
+  // Segment times are tracked in units of 0.1 msec. The buffer is filled up to the time held by
+  // a full buffer of DT_SEGMENT segments.
+  #define SEGMENT_TIME_UNITS_PER_MINUTE 600000.0
+  #define SEGMENT_BUFFER_TIME ((SEGMENT_BUFFER_SIZE-1)*(10000/ACCELERATION_TICKS_PER_SECOND))
+#endif
 #define REQ_MM_INCREMENT_SCALAR 1.25
 #define RAMP_ACCEL 0
 #define RAMP_CRUISE 1
@@ -51,6 +57,13 @@
 #define AMASS_LEVEL2 (F_CPU/4000) // Over-drives ISR (x4)
 #define AMASS_LEVEL3 (F_CPU/2000) // Over-drives ISR (x8)
 
+#ifdef STEP_RATE_RAMPS
+  // Bounds the ratio of the entry and exit speeds of a ramped segment. The end periods then stay
+  // within 2/3 and 4/3 of the average, and segments starting or ending at rest are still ramped.
+  #define RAMP_MAX_SPEED_RATIO 2.0
+  #define RAMP_MAX_CYCLES 0xC000 // Average period limit, so the longest ramp period fits Timer1.
+#endif
+
 
 // Stores the planner block Bresenham algorithm execution data for the segments in the segment
 // buffer. Normally, this buffer is partially in-use, but, for the worst case scenario, it will
@@ -63,14 +76,34 @@
   uint32_t steps[N_AXIS];
   uint32_t step_event_count;
   uint8_t direction_bits[N_AXIS];
+  uint8_t dir_outbits[N_AXIS];  // Direction bits with the port invert mask applied, ready for output.
+  uint8_t step_axes;            // Axes with steps in this block. Bit per axis index.
   uint8_t is_pwm_rate_adjusted; // Tracks motions that require constant laser power/rate
+  #ifdef LASER_RASTER
+    uint32_t raster_steps;  // Bresenham pixel increment, scaled like the axis steps.
+    uint16_t raster_start;  // Raster buffer index of the first pixel.
+    uint8_t raster_count;   // Pixels along the block. Zero, if not a raster block.
+  #endif
+  #ifdef ENABLE_JOB_CHECKPOINT
+    int32_t line_number;
+  #endif
   } st_block_t;
 #else
   typedef struct {
     uint32_t steps[N_AXIS];
     uint32_t step_event_count;
     uint8_t direction_bits;
+    uint8_t dir_outbits;  // Direction bits with the port invert mask applied, ready for output.
+    uint8_t step_axes;    // Axes with steps in this block. Bit per axis index.
     uint8_t is_pwm_rate_adjusted; // Tracks motions that require constant laser power/rate
+    #ifdef LASER_RASTER
+      uint32_t raster_steps;  // Bresenham pixel increment, scaled like the axis steps.
+      uint16_t raster_start;  // Raster buffer index of the first pixel.
+      uint8_t raster_count;   // Pixels along the block. Zero, if not a raster block.
+    #endif
+    #ifdef ENABLE_JOB_CHECKPOINT
+      int32_t line_number;
+    #endif
   } st_block_t;
 #endif // Ramps Board
 
@@ -83,13 +116,26 @@ static st_block_t st_block_buffer[SEGMENT_BUFFER_SIZE-1];
 typedef struct {
   uint16_t n_step;           // Number of step events to be executed for this segment
   uint16_t cycles_per_tick;  // Step distance traveled per ISR tick, aka step rate.
+  #ifdef STEP_RATE_RAMPS
+    int32_t cycles_delta;    // Change of cycles_per_tick per ISR tick. 16.16 fixed-point.
+  #endif
   uint8_t  st_block_index;   // Stepper block data index. Uses this information to execute this segment.
   #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
     uint8_t amass_level;    // Indicates AMASS level for the ISR to execute this segment
+    uint32_t steps[N_AXIS]; // Bresenham axis increments of the block scaled to the AMASS level.
+    #ifdef LASER_RASTER
+      uint32_t raster_steps; // Bresenham pixel increment of the block scaled to the AMASS level.
+    #endif
   #else
     uint8_t prescaler;      // Without AMASS, a prescaler is required to adjust for slow timing.
   #endif
   uint16_t spindle_pwm;
+  #ifdef SEGMENT_CRUISE_TIME_SCALE
+    uint16_t duration;       // Execution time of the segment. (0.1 msec)
+  #endif
+  #ifdef MOTOR_CURRENT_PROFILES
+    uint8_t current_phase;   // Motor current phase. Boost, if the segment ramps at all.
+  #endif
 } segment_t;
 static segment_t segment_buffer[SEGMENT_BUFFER_SIZE];
 
@@ -130,14 +176,28 @@ typedef struct {
     uint8_t step_outbits;         // The next stepping-bits to be output
     uint8_t dir_outbits;
   #endif //Ramps Board
+  uint8_t step_axes;        // Axes with steps in the executing block. Others are skipped.
   #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
-    uint32_t steps[N_AXIS];
+    uint32_t *steps;        // Bresenham axis increments of the executing segment.
+  #endif
+  #ifdef LASER_RASTER
+    uint32_t counter_raster; // Bresenham counter of the raster pixels.
+    uint32_t raster_steps;   // Bresenham pixel increment of the executing segment.
+    uint16_t raster_index;   // Raster buffer index of the pixel being output.
+    uint16_t raster_pwm;     // Segment spindle PWM value, which the pixels scale.
+    uint8_t raster_pixels;   // Pixels left in the block, including the one being output.
   #endif
 
   uint16_t step_count;       // Steps remaining in line segment motion
   uint8_t exec_block_index; // Tracks the current st_block index. Change indicates new block.
   st_block_t *exec_block;   // Pointer to the block data for the segment being executed
   segment_t *exec_segment;  // Pointer to the segment being executed
+  #ifdef STEP_RATE_RAMPS
+    uint32_t cycles_per_tick; // Ramped period of the executing segment. 16.16 fixed-point.
+  #endif
+  #ifdef ENABLE_JOB_CHECKPOINT
+    int32_t exec_line_number; // Line number of the executing block. Kept apart, since prep may reuse its slot.
+  #endif
 } stepper_t;
 static stepper_t st;
 
@@ -170,13 +230,21 @@ typedef struct {
   uint8_t recalculate_flag;
 
   float dt_remainder;
-  float steps_remaining;
+  #ifdef SEGMENT_PREP_INTEGER_STEPS
+    uint32_t steps_remaining;
+  #else
+    float steps_remaining;
+  #endif
   float step_per_mm;
   float req_mm_increment;
 
   #ifdef PARKING_ENABLE
     uint8_t last_st_block_index;
-    float last_steps_remaining;
+    #ifdef SEGMENT_PREP_INTEGER_STEPS
+      uint32_t last_steps_remaining;
+    #else
+      float last_steps_remaining;
+    #endif
     float last_step_per_mm;
     float last_dt_remainder;
   #endif
@@ -248,32 +316,36 @@ void st_wake_up()
     int idx;
   #endif // Ramps Board
 
+  #ifdef MOTOR_CURRENT_PROFILES
+    current_update(); // Raise the motor current for the first ramp before it starts.
+  #endif
+
   // Enable stepper drivers.
   #ifdef DEFAULTS_RAMPS_BOARD
     if (bit_istrue(settings.flags,BITFLAG_INVERT_ST_ENABLE)) {
       STEPPER_DISABLE_PORT(0) |= (1 << STEPPER_DISABLE_BIT(0));
       STEPPER_DISABLE_PORT(1) |= (1 << STEPPER_DISABLE_BIT(1));
       STEPPER_DISABLE_PORT(2) |= (1 << STEPPER_DISABLE_BIT(2));
-      #if N_AXIS > 3
+      #if (N_AXIS > 3) && !INDEXER_DRIVES_AXIS(3)
         STEPPER_DISABLE_PORT(3) |= (1 << STEPPER_DISABLE_BIT(3));
       #endif
-      #if N_AXIS > 4
+      #if (N_AXIS > 4) && !INDEXER_DRIVES_AXIS(4)
         STEPPER_DISABLE_PORT(4) |= (1 << STEPPER_DISABLE_BIT(4));
       #endif
-      #if N_AXIS > 5
+      #if (N_AXIS > 5) && !INDEXER_DRIVES_AXIS(5)
         STEPPER_DISABLE_PORT(5) |= (1 << STEPPER_DISABLE_BIT(5));
       #endif
     } else {
       STEPPER_DISABLE_PORT(0) &= ~(1 << STEPPER_DISABLE_BIT(0));
       STEPPER_DISABLE_PORT(1) &= ~(1 << STEPPER_DISABLE_BIT(1));
       STEPPER_DISABLE_PORT(2) &= ~(1 << STEPPER_DISABLE_BIT(2));
-      #if N_AXIS > 3
+      #if (N_AXIS > 3) && !INDEXER_DRIVES_AXIS(3)
         STEPPER_DISABLE_PORT(3) &= ~(1 << STEPPER_DISABLE_BIT(3));
       #endif
-      #if N_AXIS > 4
+      #if (N_AXIS > 4) && !INDEXER_DRIVES_AXIS(4)
         STEPPER_DISABLE_PORT(4) &= ~(1 << STEPPER_DISABLE_BIT(4));
       #endif
-      #if N_AXIS > 5
+      #if (N_AXIS > 5) && !INDEXER_DRIVES_AXIS(5)
         STEPPER_DISABLE_PORT(5) &= ~(1 << STEPPER_DISABLE_BIT(5));
       #endif
     }
@@ -326,26 +398,26 @@ void st_go_idle()
       STEPPER_DISABLE_PORT(0) |= (1 << STEPPER_DISABLE_BIT(0));
       STEPPER_DISABLE_PORT(1) |= (1 << STEPPER_DISABLE_BIT(1));
       STEPPER_DISABLE_PORT(2) |= (1 << STEPPER_DISABLE_BIT(2));
-      #if N_AXIS > 3
+      #if (N_AXIS > 3) && !INDEXER_DRIVES_AXIS(3)
         STEPPER_DISABLE_PORT(3) |= (1 << STEPPER_DISABLE_BIT(3));
       #endif
-      #if N_AXIS > 4
+      #if (N_AXIS > 4) && !INDEXER_DRIVES_AXIS(4)
         STEPPER_DISABLE_PORT(4) |= (1 << STEPPER_DISABLE_BIT(4));
       #endif
-      #if N_AXIS > 5
+      #if (N_AXIS > 5) && !INDEXER_DRIVES_AXIS(5)
         STEPPER_DISABLE_PORT(5) |= (1 << STEPPER_DISABLE_BIT(5));
       #endif
     } else {
       STEPPER_DISABLE_PORT(0) &= ~(1 << STEPPER_DISABLE_BIT(0));
       STEPPER_DISABLE_PORT(1) &= ~(1 << STEPPER_DISABLE_BIT(1));
       STEPPER_DISABLE_PORT(2) &= ~(1 << STEPPER_DISABLE_BIT(2));
-      #if N_AXIS > 3
+      #if (N_AXIS > 3) && !INDEXER_DRIVES_AXIS(3)
         STEPPER_DISABLE_PORT(3) &= ~(1 << STEPPER_DISABLE_BIT(3));
       #endif
-      #if N_AXIS > 4
+      #if (N_AXIS > 4) && !INDEXER_DRIVES_AXIS(4)
         STEPPER_DISABLE_PORT(4) &= ~(1 << STEPPER_DISABLE_BIT(4));
       #endif
-      #if N_AXIS > 5
+      #if (N_AXIS > 5) && !INDEXER_DRIVES_AXIS(5)
         STEPPER_DISABLE_PORT(5) &= ~(1 << STEPPER_DISABLE_BIT(5));
       #endif
     }
@@ -353,9 +425,26 @@ void st_go_idle()
     if (pin_state) { STEPPERS_DISABLE_PORT |= (1<<STEPPERS_DISABLE_BIT); }
     else { STEPPERS_DISABLE_PORT &= ~(1<<STEPPERS_DISABLE_BIT); }
   #endif // Ramps Board
+  #ifdef INDEXER_AXIS
+    indexer_go_idle(pin_state);
+  #endif
 }
 
 
+#ifdef LASER_RASTER
+  // Writes the power of the current raster pixel to the spindle PWM. Pixel values 0-255 scale the
+  // segment PWM value from off to full. Called by the stepper ISR only.
+  static inline void st_raster_output()
+  {
+    uint8_t pixel = raster_buffer[st.raster_index];
+    uint16_t pwm_value = ((uint32_t)(pixel + (pixel >> 7))*st.raster_pwm) >> 8;
+    SPINDLE_OCR_REGISTER = pwm_value;
+    if (pwm_value == SPINDLE_PWM_OFF_VALUE) { SPINDLE_TCCRA_REGISTER &= ~(1<<SPINDLE_COMB_BIT); } // Output voltage is zero.
+    else { SPINDLE_TCCRA_REGISTER |= (1<<SPINDLE_COMB_BIT); }
+  }
+#endif
+
+
 /* "The Stepper Driver Interrupt" - This timer interrupt is the workhorse of Grbl. Grbl employs
    the venerable Bresenham line algorithm to manage and exactly synchronize multi-axis moves.
    Unlike the popular DDA algorithm, the Bresenham algorithm is not susceptible to numerical
@@ -417,13 +506,13 @@ ISR(TIMER1_COMPA_vect)
     DIRECTION_PORT(0) = (DIRECTION_PORT(0) & ~(1 << DIRECTION_BIT(0))) | st.dir_outbits[0];
     DIRECTION_PORT(1) = (DIRECTION_PORT(1) & ~(1 << DIRECTION_BIT(1))) | st.dir_outbits[1];
     DIRECTION_PORT(2) = (DIRECTION_PORT(2) & ~(1 << DIRECTION_BIT(2))) | st.dir_outbits[2];
-    #if N_AXIS > 3
+    #if (N_AXIS > 3) && !INDEXER_DRIVES_AXIS(3)
     DIRECTION_PORT(3) = (DIRECTION_PORT(3) & ~(1 << DIRECTION_BIT(3))) | st.dir_outbits[3];
     #endif
-    #if N_AXIS > 4
+    #if (N_AXIS > 4) && !INDEXER_DRIVES_AXIS(4)
     DIRECTION_PORT(4) = (DIRECTION_PORT(4) & ~(1 << DIRECTION_BIT(4))) | st.dir_outbits[4];
     #endif
-    #if N_AXIS > 5
+    #if (N_AXIS > 5) && !INDEXER_DRIVES_AXIS(5)
     DIRECTION_PORT(5) = (DIRECTION_PORT(5) & ~(1 << DIRECTION_BIT(5))) | st.dir_outbits[5];
     #endif
   #else
@@ -436,26 +525,26 @@ ISR(TIMER1_COMPA_vect)
       st.step_bits[0] = (STEP_PORT(0) & ~(1 << STEP_BIT(0))) | st.step_outbits[0]; // Store out_bits to prevent overwriting.
       st.step_bits[1] = (STEP_PORT(1) & ~(1 << STEP_BIT(1))) | st.step_outbits[1]; // Store out_bits to prevent overwriting.
       st.step_bits[2] = (STEP_PORT(2) & ~(1 << STEP_BIT(2))) | st.step_outbits[2]; // Store out_bits to prevent overwriting.
-      #if N_AXIS > 3
+      #if (N_AXIS > 3) && !INDEXER_DRIVES_AXIS(3)
         st.step_bits[3] = (STEP_PORT(3) & ~(1 << STEP_BIT(3))) | st.step_outbits[3]; // Store out_bits to prevent overwriting.
       #endif
-      #if N_AXIS > 4
+      #if (N_AXIS > 4) && !INDEXER_DRIVES_AXIS(4)
         st.step_bits[4] = (STEP_PORT(4) & ~(1 << STEP_BIT(4))) | st.step_outbits[4]; // Store out_bits to prevent overwriting.
       #endif
-      #if N_AXIS > 5
+      #if (N_AXIS > 5) && !INDEXER_DRIVES_AXIS(5)
         st.step_bits[5] = (STEP_PORT(5) & ~(1 << STEP_BIT(5))) | st.step_outbits[5]; // Store out_bits to prevent overwriting.
       #endif
     #else
       STEP_PORT(0) = (STEP_PORT(0) & ~(1 << STEP_BIT(0))) | st.step_outbits[0];
       STEP_PORT(1) = (STEP_PORT(1) & ~(1 << STEP_BIT(1))) | st.step_outbits[1];
       STEP_PORT(2) = (STEP_PORT(2) & ~(1 << STEP_BIT(2))) | st.step_outbits[2];
-      #if N_AXIS > 3
+      #if (N_AXIS > 3) && !INDEXER_DRIVES_AXIS(3)
         STEP_PORT(3) = (STEP_PORT(3) & ~(1 << STEP_BIT(3))) | st.step_outbits[3];
       #endif
-      #if N_AXIS > 4
+      #if (N_AXIS > 4) && !INDEXER_DRIVES_AXIS(4)
         STEP_PORT(4) = (STEP_PORT(4) & ~(1 << STEP_BIT(4))) | st.step_outbits[4];
       #endif
-      #if N_AXIS > 5
+      #if (N_AXIS > 5) && !INDEXER_DRIVES_AXIS(5)
         STEP_PORT(5) = (STEP_PORT(5) & ~(1 << STEP_BIT(5))) | st.step_outbits[5];
       #endif
     #endif
@@ -490,12 +579,23 @@ ISR(TIMER1_COMPA_vect)
 
       // Initialize step segment timing per step and load number of steps to execute.
       OCR1A = st.exec_segment->cycles_per_tick;
+      #ifdef STEP_RATE_RAMPS
+        st.cycles_per_tick = (uint32_t)st.exec_segment->cycles_per_tick << 16;
+      #endif
       st.step_count = st.exec_segment->n_step; // NOTE: Can sometimes be zero when moving slow.
       // If the new segment starts a new planner block, initialize stepper variables and counters.
       // NOTE: When the segment data index changes, this indicates a new planner block.
       if ( st.exec_block_index != st.exec_segment->st_block_index ) {
         st.exec_block_index = st.exec_segment->st_block_index;
         st.exec_block = &st_block_buffer[st.exec_block_index];
+        #ifdef ENABLE_JOB_CHECKPOINT
+          // A block of the next numbered line completes the previous one. Blocks of unnumbered lines
+          // and parking motions are passed over.
+          if (st.exec_block->line_number && (st.exec_block->line_number != st.exec_line_number)) {
+            if (st.exec_line_number) { checkpoint.line_number = st.exec_line_number; }
+            st.exec_line_number = st.exec_block->line_number;
+          }
+        #endif
 
         // Initialize Bresenham line and distance counters
         #if N_AXIS == 4
@@ -507,42 +607,71 @@ ISR(TIMER1_COMPA_vect)
         #else
           st.counter_x = st.counter_y = st.counter_z = (st.exec_block->step_event_count >> 1);
         #endif
+
+        // Direction bits and active axes are prepared with the block and only change with it.
+        #ifdef DEFAULTS_RAMPS_BOARD
+          for (i = 0; i < N_AXIS; i++)
+            st.dir_outbits[i] = st.exec_block->dir_outbits[i];
+        #else
+          st.dir_outbits = st.exec_block->dir_outbits;
+        #endif // Ramps Board
+        st.step_axes = st.exec_block->step_axes;
+
+        #ifdef LASER_RASTER
+          // The first pixel is output at the segment load below. The counter then starts at zero,
+          // so the following pixels begin at even fractions of the block.
+          st.raster_pixels = st.exec_block->raster_count;
+          if (st.raster_pixels) {
+            st.raster_index = st.exec_block->raster_start;
+            raster_buffer_tail = st.raster_index; // Releases the pixels of the blocks before.
+            st.counter_raster = 0;
+          }
+        #endif
       }
-      #ifdef DEFAULTS_RAMPS_BOARD
-        for (i = 0; i < N_AXIS; i++)
-          st.dir_outbits[i] = st.exec_block->direction_bits[i] ^ dir_port_invert_mask[i];
-      #else
-        st.dir_outbits = st.exec_block->direction_bits ^ dir_port_invert_mask;
-      #endif // Ramps Board
 
       #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
-        // With AMASS enabled, adjust Bresenham axis increment counters according to AMASS level.
-        st.steps[AXIS_1] = st.exec_block->steps[AXIS_1] >> st.exec_segment->amass_level;
-        st.steps[AXIS_2] = st.exec_block->steps[AXIS_2] >> st.exec_segment->amass_level;
-        st.steps[AXIS_3] = st.exec_block->steps[AXIS_3] >> st.exec_segment->amass_level;
-        #if N_AXIS > 3
-          st.steps[AXIS_4] = st.exec_block->steps[AXIS_4] >> st.exec_segment->amass_level;
-        #endif
-        #if N_AXIS > 4
-          st.steps[AXIS_5] = st.exec_block->steps[AXIS_5] >> st.exec_segment->amass_level;
-        #endif
-        #if N_AXIS > 5
-          st.steps[AXIS_6] = st.exec_block->steps[AXIS_6] >> st.exec_segment->amass_level;
-        #endif
+        // With AMASS enabled, use the Bresenham axis increments prepared for the segment's AMASS level.
+        st.steps = st.exec_segment->steps;
       #endif
 
       // Set real-time spindle output as segment is loaded, just prior to the first step.
+      #ifdef LASER_RASTER
+        if (st.raster_pixels) {
+          // Raster blocks output the current pixel, scaled to the power of the new segment.
+          #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+            st.raster_steps = st.exec_segment->raster_steps;
+          #else
+            st.raster_steps = st.exec_block->raster_steps;
+          #endif
+          st.raster_pwm = st.exec_segment->spindle_pwm;
+          st_raster_output();
+        } else
+      #endif
       spindle_set_speed(st.exec_segment->spindle_pwm);
 
     } else {
       // Segment buffer empty. Shutdown.
+      #ifdef ENABLE_PERFORMANCE_COUNTERS
+        // Running dry in a cycle while the planner still holds a block means segment prep fell behind.
+        if ((sys.state == STATE_CYCLE) && (plan_get_current_block() != NULL)) { perf.segment_underrun++; }
+      #endif
       st_go_idle();
       // Ensure pwm is set properly upon completion of rate-controlled motion.
       if (st.exec_block->is_pwm_rate_adjusted) { spindle_set_speed(SPINDLE_PWM_OFF_VALUE); }
+      #ifdef LASER_RASTER
+        else if (st.exec_block->raster_count) { spindle_set_speed(SPINDLE_PWM_OFF_VALUE); } // Don't hold the last pixel.
+      #endif
       system_set_exec_state_flag(EXEC_CYCLE_STOP); // Flag main program for cycle end
       return; // Nothing to do but exit.
     }
   }
+  #ifdef STEP_RATE_RAMPS
+    else {
+      // Ramp the period to the next tick of the executing segment.
+      st.cycles_per_tick += st.exec_segment->cycles_delta;
+      OCR1A = st.cycles_per_tick >> 16;
+    }
+  #endif
 
 
   // Check probing state.
@@ -557,113 +686,169 @@ ISR(TIMER1_COMPA_vect)
   #endif // Ramps Board
 
   // Execute step displacement profile by Bresenham line algorithm
-  #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
-    st.counter_x += st.steps[AXIS_1];
-  #else
-    st.counter_x += st.exec_block->steps[AXIS_1];
-  #endif
-  #ifdef DEFAULTS_RAMPS_BOARD
-    if (st.counter_x > st.exec_block->step_event_count) {
-      st.step_outbits[AXIS_1] |= (1<<STEP_BIT(AXIS_1));
-      st.counter_x -= st.exec_block->step_event_count;
-      if (st.exec_block->direction_bits[AXIS_1] & (1<<DIRECTION_BIT(AXIS_1))) { sys_position[AXIS_1]--; }
-      else { sys_position[AXIS_1]++; }
-    }
-  #else
-    if (st.counter_x > st.exec_block->step_event_count) {
-      st.step_outbits |= (1<<X_STEP_BIT);
-      st.counter_x -= st.exec_block->step_event_count;
-      if (st.exec_block->direction_bits & (1<<X_DIRECTION_BIT)) { sys_position[AXIS_1]--; }
-      else { sys_position[AXIS_1]++; }
-    }
-  #endif // Ramps Board
-
-  #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
-    st.counter_y += st.steps[AXIS_2];
-  #else
-    st.counter_y += st.exec_block->steps[AXIS_2];
-  #endif
-  #ifdef DEFAULTS_RAMPS_BOARD
-    if (st.counter_y > st.exec_block->step_event_count) {
-      st.step_outbits[AXIS_2] |= (1<<STEP_BIT(AXIS_2));
-      st.counter_y -= st.exec_block->step_event_count;
-      if (st.exec_block->direction_bits[AXIS_2] & (1<<DIRECTION_BIT(AXIS_2))) { sys_position[AXIS_2]--; }
-      else { sys_position[AXIS_2]++; }
-    }
-  #else
-    if (st.counter_y > st.exec_block->step_event_count) {
-      st.step_outbits |= (1<<Y_STEP_BIT);
-      st.counter_y -= st.exec_block->step_event_count;
-      if (st.exec_block->direction_bits & (1<<Y_DIRECTION_BIT)) { sys_position[AXIS_2]--; }
-      else { sys_position[AXIS_2]++; }
-    }
-  #endif // Ramps Board
-  #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
-    st.counter_z += st.steps[AXIS_3];
-  #else
-    st.counter_z += st.exec_block->steps[AXIS_3];
-  #endif
-  #ifdef DEFAULTS_RAMPS_BOARD
-    if (st.counter_z > st.exec_block->step_event_count) {
-      st.step_outbits[AXIS_3] |= (1<<STEP_BIT(AXIS_3));
-      st.counter_z -= st.exec_block->step_event_count;
-      if (st.exec_block->direction_bits[AXIS_3] & (1<<DIRECTION_BIT(AXIS_3))) { sys_position[AXIS_3]--; }
-      else { sys_position[AXIS_3]++; }
-    }
-  #else
-    if (st.counter_z > st.exec_block->step_event_count) {
-      st.step_outbits |= (1<<Z_STEP_BIT);
-      st.counter_z -= st.exec_block->step_event_count;
-      if (st.exec_block->direction_bits & (1<<Z_DIRECTION_BIT)) { sys_position[AXIS_3]--; }
-      else { sys_position[AXIS_3]++; }
-    }
-  #endif // Ramps Board
-  #if N_AXIS > 3
+  if (st.step_axes & bit(AXIS_1)) {
     #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
-      st.counter_4 += st.steps[AXIS_4];
+      st.counter_x += st.steps[AXIS_1];
     #else
-      st.counter_4 += st.exec_block->steps[AXIS_4];
+      st.counter_x += st.exec_block->steps[AXIS_1];
     #endif
     #ifdef DEFAULTS_RAMPS_BOARD
-      if (st.counter_4 > st.exec_block->step_event_count) {
-        st.step_outbits[AXIS_4] |= (1<<STEP_BIT(AXIS_4));
-        st.counter_4 -= st.exec_block->step_event_count;
-        if (st.exec_block->direction_bits[AXIS_4] & (1<<DIRECTION_BIT(AXIS_4))) { sys_position[AXIS_4]--; }
-        else { sys_position[AXIS_4]++; }
+      if (st.counter_x > st.exec_block->step_event_count) {
+        st.step_outbits[AXIS_1] |= (1<<STEP_BIT(AXIS_1));
+        st.counter_x -= st.exec_block->step_event_count;
+        if (st.exec_block->direction_bits[AXIS_1] & (1<<DIRECTION_BIT(AXIS_1))) { sys_position[AXIS_1]--; }
+        else { sys_position[AXIS_1]++; }
+      }
+    #else
+      if (st.counter_x > st.exec_block->step_event_count) {
+        st.step_outbits |= (1<<X_STEP_BIT);
+        st.counter_x -= st.exec_block->step_event_count;
+        if (st.exec_block->direction_bits & (1<<X_DIRECTION_BIT)) { sys_position[AXIS_1]--; }
+        else { sys_position[AXIS_1]++; }
       }
     #endif // Ramps Board
-  #endif // N_AXIS > 3
-  #if N_AXIS > 4
+  }
+
+  if (st.step_axes & bit(AXIS_2)) {
     #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
-      st.counter_5 += st.steps[AXIS_5];
+      st.counter_y += st.steps[AXIS_2];
     #else
-      st.counter_5 += st.exec_block->steps[AXIS_5];
+      st.counter_y += st.exec_block->steps[AXIS_2];
     #endif
     #ifdef DEFAULTS_RAMPS_BOARD
-      if (st.counter_5 > st.exec_block->step_event_count) {
-        st.step_outbits[AXIS_5] |= (1<<STEP_BIT(AXIS_5));
-        st.counter_5 -= st.exec_block->step_event_count;
-        if (st.exec_block->direction_bits[AXIS_5] & (1<<DIRECTION_BIT(AXIS_5))) { sys_position[AXIS_5]--; }
-        else { sys_position[AXIS_5]++; }
+      if (st.counter_y > st.exec_block->step_event_count) {
+        st.step_outbits[AXIS_2] |= (1<<STEP_BIT(AXIS_2));
+        st.counter_y -= st.exec_block->step_event_count;
+        if (st.exec_block->direction_bits[AXIS_2] & (1<<DIRECTION_BIT(AXIS_2))) { sys_position[AXIS_2]--; }
+        else { sys_position[AXIS_2]++; }
+      }
+    #else
+      if (st.counter_y > st.exec_block->step_event_count) {
+        st.step_outbits |= (1<<Y_STEP_BIT);
+        st.counter_y -= st.exec_block->step_event_count;
+        if (st.exec_block->direction_bits & (1<<Y_DIRECTION_BIT)) { sys_position[AXIS_2]--; }
+        else { sys_position[AXIS_2]++; }
       }
     #endif // Ramps Board
-  #endif // N_AXIS > 4
-  #if N_AXIS > 5
+  }
+  if (st.step_axes & bit(AXIS_3)) {
     #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
-      st.counter_6 += st.steps[AXIS_6];
+      st.counter_z += st.steps[AXIS_3];
     #else
-      st.counter_6 += st.exec_block->steps[AXIS_6];
+      st.counter_z += st.exec_block->steps[AXIS_3];
     #endif
     #ifdef DEFAULTS_RAMPS_BOARD
-      if (st.counter_6 > st.exec_block->step_event_count) {
-        st.step_outbits[AXIS_6] |= (1<<STEP_BIT(AXIS_6));
-        st.counter_6 -= st.exec_block->step_event_count;
-        if (st.exec_block->direction_bits[AXIS_6] & (1<<DIRECTION_BIT(AXIS_6))) { sys_position[AXIS_6]--; }
-        else { sys_position[AXIS_6]++; }
+      if (st.counter_z > st.exec_block->step_event_count) {
+        st.step_outbits[AXIS_3] |= (1<<STEP_BIT(AXIS_3));
+        st.counter_z -= st.exec_block->step_event_count;
+        if (st.exec_block->direction_bits[AXIS_3] & (1<<DIRECTION_BIT(AXIS_3))) { sys_position[AXIS_3]--; }
+        else { sys_position[AXIS_3]++; }
+      }
+    #else
+      if (st.counter_z > st.exec_block->step_event_count) {
+        st.step_outbits |= (1<<Z_STEP_BIT);
+        st.counter_z -= st.exec_block->step_event_count;
+        if (st.exec_block->direction_bits & (1<<Z_DIRECTION_BIT)) { sys_position[AXIS_3]--; }
+        else { sys_position[AXIS_3]++; }
       }
     #endif // Ramps Board
+  }
+  #if N_AXIS > 3
+    #ifdef AXIS_4_MASTER
+      // A ganged motor steps with its master, except while homing squares the axis.
+      if (sys.state != STATE_HOMING) {
+        if (st.step_outbits[AXIS_4_MASTER]) {
+          st.step_outbits[AXIS_4] |= (1<<STEP_BIT(AXIS_4));
+          if (st.exec_block->direction_bits[AXIS_4] & (1<<DIRECTION_BIT(AXIS_4))) { sys_position[AXIS_4]--; }
+          else { sys_position[AXIS_4]++; }
+        }
+      } else
+    #endif
+    if (st.step_axes & bit(AXIS_4)) {
+      #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+        st.counter_4 += st.steps[AXIS_4];
+      #else
+        st.counter_4 += st.exec_block->steps[AXIS_4];
+      #endif
+      #ifdef DEFAULTS_RAMPS_BOARD
+        if (st.counter_4 > st.exec_block->step_event_count) {
+          st.step_outbits[AXIS_4] |= (1<<STEP_BIT(AXIS_4));
+          st.counter_4 -= st.exec_block->step_event_count;
+          if (st.exec_block->direction_bits[AXIS_4] & (1<<DIRECTION_BIT(AXIS_4))) { sys_position[AXIS_4]--; }
+          else { sys_position[AXIS_4]++; }
+        }
+      #endif // Ramps Board
+    }
+  #endif // N_AXIS > 3
+  #if N_AXIS > 4
+    #ifdef AXIS_5_MASTER
+      // A ganged motor steps with its master, except while homing squares the axis.
+      if (sys.state != STATE_HOMING) {
+        if (st.step_outbits[AXIS_5_MASTER]) {
+          st.step_outbits[AXIS_5] |= (1<<STEP_BIT(AXIS_5));
+          if (st.exec_block->direction_bits[AXIS_5] & (1<<DIRECTION_BIT(AXIS_5))) { sys_position[AXIS_5]--; }
+          else { sys_position[AXIS_5]++; }
+        }
+      } else
+    #endif
+    if (st.step_axes & bit(AXIS_5)) {
+      #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+        st.counter_5 += st.steps[AXIS_5];
+      #else
+        st.counter_5 += st.exec_block->steps[AXIS_5];
+      #endif
+      #ifdef DEFAULTS_RAMPS_BOARD
+        if (st.counter_5 > st.exec_block->step_event_count) {
+          st.step_outbits[AXIS_5] |= (1<<STEP_BIT(AXIS_5));
+          st.counter_5 -= st.exec_block->step_event_count;
+          if (st.exec_block->direction_bits[AXIS_5] & (1<<DIRECTION_BIT(AXIS_5))) { sys_position[AXIS_5]--; }
+          else { sys_position[AXIS_5]++; }
+        }
+      #endif // Ramps Board
+    }
+  #endif // N_AXIS > 4
+  #if N_AXIS > 5
+    #ifdef AXIS_6_MASTER
+      // A ganged motor steps with its master, except while homing squares the axis.
+      if (sys.state != STATE_HOMING) {
+        if (st.step_outbits[AXIS_6_MASTER]) {
+          st.step_outbits[AXIS_6] |= (1<<STEP_BIT(AXIS_6));
+          if (st.exec_block->direction_bits[AXIS_6] & (1<<DIRECTION_BIT(AXIS_6))) { sys_position[AXIS_6]--; }
+          else { sys_position[AXIS_6]++; }
+        }
+      } else
+    #endif
+    if (st.step_axes & bit(AXIS_6)) {
+      #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+        st.counter_6 += st.steps[AXIS_6];
+      #else
+        st.counter_6 += st.exec_block->steps[AXIS_6];
+      #endif
+      #ifdef DEFAULTS_RAMPS_BOARD
+        if (st.counter_6 > st.exec_block->step_event_count) {
+          st.step_outbits[AXIS_6] |= (1<<STEP_BIT(AXIS_6));
+          st.counter_6 -= st.exec_block->step_event_count;
+          if (st.exec_block->direction_bits[AXIS_6] & (1<<DIRECTION_BIT(AXIS_6))) { sys_position[AXIS_6]--; }
+          else { sys_position[AXIS_6]++; }
+        }
+      #endif // Ramps Board
+    }
   #endif // N_AXIS > 5
 
+  #ifdef LASER_RASTER
+    // Advance the raster pixels like an axis, so they are spaced evenly along the block.
+    if (st.raster_pixels > 1) {
+      st.counter_raster += st.raster_steps;
+      if (st.counter_raster > st.exec_block->step_event_count) {
+        st.counter_raster -= st.exec_block->step_event_count;
+        st.raster_pixels--;
+        if (++st.raster_index == RASTER_BUFFER_SIZE) { st.raster_index = 0; }
+        raster_buffer_tail = st.raster_index;
+        st_raster_output();
+      }
+    }
+  #endif
+
   // During a homing cycle, lock out and prevent desired axes from moving.
   #ifdef DEFAULTS_RAMPS_BOARD
     for (i = 0; i < N_AXIS; i++)
@@ -683,6 +868,11 @@ ISR(TIMER1_COMPA_vect)
   #else
     st.step_outbits ^= step_port_invert_mask;  // Apply step port invert mask
   #endif // Ramps Board
+  #ifdef ENABLE_PERFORMANCE_COUNTERS
+    // Timer1 is cleared on compare match, so its count is the time spent since this ISR fired.
+    uint16_t isr_ticks = TCNT1;
+    PERF_SAMPLE(perf.step_isr_max, perf.step_isr_avg, isr_ticks);
+  #endif
   busy = false;
 }
 
@@ -705,13 +895,13 @@ ISR(TIMER0_OVF_vect)
     STEP_PORT(0) = (STEP_PORT(0) & ~(1 << STEP_BIT(0))) | step_port_invert_mask[0];
     STEP_PORT(1) = (STEP_PORT(1) & ~(1 << STEP_BIT(1))) | step_port_invert_mask[1];
     STEP_PORT(2) = (STEP_PORT(2) & ~(1 << STEP_BIT(2))) | step_port_invert_mask[2];
-    #if N_AXIS > 3
+    #if (N_AXIS > 3) && !INDEXER_DRIVES_AXIS(3)
       STEP_PORT(3) = (STEP_PORT(3) & ~(1 << STEP_BIT(3))) | step_port_invert_mask[3];
     #endif
-    #if N_AXIS > 4
+    #if (N_AXIS > 4) && !INDEXER_DRIVES_AXIS(4)
       STEP_PORT(4) = (STEP_PORT(4) & ~(1 << STEP_BIT(4))) | step_port_invert_mask[4];
     #endif
-    #if N_AXIS > 5
+    #if (N_AXIS > 5) && !INDEXER_DRIVES_AXIS(5)
       STEP_PORT(5) = (STEP_PORT(5) & ~(1 << STEP_BIT(5))) | step_port_invert_mask[5];
     #endif
   #else
@@ -731,13 +921,13 @@ ISR(TIMER0_OVF_vect)
       STEP_PORT(0) = st.step_bits[0]; // Begin step pulse.
       STEP_PORT(1) = st.step_bits[1]; // Begin step pulse.
       STEP_PORT(2) = st.step_bits[2]; // Begin step pulse.
-      #if N_AXIS > 3
+      #if (N_AXIS > 3) && !INDEXER_DRIVES_AXIS(3)
         STEP_PORT(3) = st.step_bits[3]; // Begin step pulse.
       #endif
-      #if N_AXIS > 4
+      #if (N_AXIS > 4) && !INDEXER_DRIVES_AXIS(4)
         STEP_PORT(4) = st.step_bits[4]; // Begin step pulse.
       #endif
-      #if N_AXIS > 5
+      #if (N_AXIS > 5) && !INDEXER_DRIVES_AXIS(5)
         STEP_PORT(5) = st.step_bits[5]; // Begin step pulse.
       #endif
     #else
@@ -801,15 +991,15 @@ void st_reset()
 
     STEP_PORT(2) = (STEP_PORT(2) & ~(1 << STEP_BIT(2))) | step_port_invert_mask[2];
     DIRECTION_PORT(2) = (DIRECTION_PORT(2) & ~(1 << DIRECTION_BIT(2))) | dir_port_invert_mask[2];
-    #if N_AXIS > 3
+    #if (N_AXIS > 3) && !INDEXER_DRIVES_AXIS(3)
       STEP_PORT(3) = (STEP_PORT(3) & ~(1 << STEP_BIT(3))) | step_port_invert_mask[3];
       DIRECTION_PORT(3) = (DIRECTION_PORT(3) & ~(1 << DIRECTION_BIT(3))) | dir_port_invert_mask[3];
     #endif
-    #if N_AXIS > 4
+    #if (N_AXIS > 4) && !INDEXER_DRIVES_AXIS(4)
       STEP_PORT(4) = (STEP_PORT(4) & ~(1 << STEP_BIT(4))) | step_port_invert_mask[4];
       DIRECTION_PORT(4) = (DIRECTION_PORT(4) & ~(1 << DIRECTION_BIT(4))) | dir_port_invert_mask[4];
     #endif
-    #if N_AXIS > 5
+    #if (N_AXIS > 5) && !INDEXER_DRIVES_AXIS(5)
       STEP_PORT(5) = (STEP_PORT(5) & ~(1 << STEP_BIT(5))) | step_port_invert_mask[5];
       DIRECTION_PORT(5) = (DIRECTION_PORT(5) & ~(1 << DIRECTION_BIT(5))) | dir_port_invert_mask[5];
     #endif
@@ -949,6 +1139,49 @@ static uint8_t st_next_block_index(uint8_t block_index)
 #endif
 
 
+#ifdef SEGMENT_CRUISE_TIME_SCALE
+// Returns the execution time held by the segment buffer, including the executing segment.
+static uint16_t st_get_segment_buffer_time()
+{
+  uint16_t buffer_time = 0;
+  uint8_t index = segment_buffer_tail;
+  while (index != segment_buffer_head) {
+    buffer_time += segment_buffer[index].duration;
+    if ( ++index == SEGMENT_BUFFER_SIZE ) { index = 0; }
+  }
+  return(buffer_time);
+}
+#endif
+
+
+#ifdef MOTOR_CURRENT_PROFILES
+// Returns the highest motor current phase of the segment buffer, including the executing segment,
+// so a boost is applied ahead of the ramp and lasts until its last segment has run. Idle, if empty.
+uint8_t st_get_current_phase()
+{
+  uint8_t current_phase = CURRENT_PHASE_IDLE;
+  uint8_t index = segment_buffer_tail;
+  while (index != segment_buffer_head) {
+    if (segment_buffer[index].current_phase > current_phase) { current_phase = segment_buffer[index].current_phase; }
+    if ( ++index == SEGMENT_BUFFER_SIZE ) { index = 0; }
+  }
+  return(current_phase);
+}
+#endif
+
+
+#ifdef SEGMENT_PREP_INTEGER_STEPS
+// Rounds a non-negative value up to a whole number. Same result as converting ceil(), but without
+// its soft-float call. A truncated value of 2^24 or more is whole and converts back exactly.
+static uint32_t st_ceil_steps(float value)
+{
+  uint32_t steps = value;
+  if (steps < value) { steps++; }
+  return(steps);
+}
+#endif
+
+
 /* Prepares step segment buffer. Continuously called from main program.
 
    The segment buffer is an intermediary buffer interface between the execution of steps
@@ -964,17 +1197,32 @@ static uint8_t st_next_block_index(uint8_t block_index)
 */
 void st_prep_buffer()
 {
+  #ifdef MOTOR_CURRENT_PROFILES
+    current_update(); // Follow the segments the stepper ISR has executed since the last call.
+  #endif
+
   // Block step prep buffer, while in a suspend state and there is no suspend motion to execute.
   if (bit_istrue(sys.step_control,STEP_CONTROL_END_MOTION)) { return; }
 
+  // Continue replanning after an override change, one slice per call.
+  if (!(sys.step_control & STEP_CONTROL_EXECUTE_SYS_MOTION)) { plan_update_velocity_profile_slice(); }
+
   while (segment_buffer_tail != segment_next_head) { // Check if we need to fill the buffer.
 
+    #ifdef SEGMENT_CRUISE_TIME_SCALE
+      // Stretched cruise segments fill the buffer by time before they fill it by count.
+      if (st_get_segment_buffer_time() >= SEGMENT_BUFFER_TIME) { return; }
+    #endif
+
     // Determine if we need to load a new planner block or if the block needs to be recomputed.
     if (pl_block == NULL) {
 
       // Query planner for a queued block
       if (sys.step_control & STEP_CONTROL_EXECUTE_SYS_MOTION) { pl_block = plan_get_system_motion_block(); }
-      else { pl_block = plan_get_current_block(); }
+      else {
+        plan_update_velocity_profile_slice(); // Replan it first, if an override update hasn't yet.
+        pl_block = plan_get_current_block();
+      }
       if (pl_block == NULL) { return; } // No planner blocks. Exit.
 
       // Check if we need to only recompute the velocity profile or load a new block.
@@ -1000,10 +1248,16 @@ void st_prep_buffer()
         #ifdef DEFAULTS_RAMPS_BOARD
           for (idx=0; idx<N_AXIS; idx++) {
             st_prep_block->direction_bits[idx] = pl_block->direction_bits[idx];
+            st_prep_block->dir_outbits[idx] = pl_block->direction_bits[idx] ^ dir_port_invert_mask[idx];
           }
         #else
           st_prep_block->direction_bits = pl_block->direction_bits;
+          st_prep_block->dir_outbits = pl_block->direction_bits ^ dir_port_invert_mask;
         #endif // Ramps Board
+        st_prep_block->step_axes = 0;
+        for (idx=0; idx<N_AXIS; idx++) {
+          if (pl_block->steps[idx]) { st_prep_block->step_axes |= bit(idx); }
+        }
 
         #ifndef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
           for (idx=0; idx<N_AXIS; idx++) { st_prep_block->steps[idx] = (pl_block->steps[idx] << 1); }
@@ -1015,9 +1269,21 @@ void st_prep_buffer()
           for (idx=0; idx<N_AXIS; idx++) { st_prep_block->steps[idx] = pl_block->steps[idx] << MAX_AMASS_LEVEL; }
           st_prep_block->step_event_count = pl_block->step_event_count << MAX_AMASS_LEVEL;
         #endif
+        #ifdef LASER_RASTER
+          st_prep_block->raster_start = pl_block->raster_start;
+          st_prep_block->raster_count = pl_block->raster_count;
+          #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+            st_prep_block->raster_steps = (uint32_t)pl_block->raster_count << MAX_AMASS_LEVEL;
+          #else
+            st_prep_block->raster_steps = (uint32_t)pl_block->raster_count << 1;
+          #endif
+        #endif
+        #ifdef ENABLE_JOB_CHECKPOINT
+          st_prep_block->line_number = pl_block->line_number;
+        #endif
 
         // Initialize segment buffer data for generating the segments.
-        prep.steps_remaining = (float)pl_block->step_event_count;
+        prep.steps_remaining = pl_block->step_event_count;
         prep.step_per_mm = prep.steps_remaining/pl_block->millimeters;
         prep.req_mm_increment = REQ_MM_INCREMENT_SCALAR/prep.step_per_mm;
         prep.dt_remainder = 0.0; // Reset for new segment block
@@ -1158,15 +1424,27 @@ void st_prep_buffer()
       such as from a feed hold.
     */
     float dt_max = DT_SEGMENT; // Maximum segment time
+    #ifdef SEGMENT_CRUISE_TIME_SCALE
+      if (prep.ramp_type == RAMP_CRUISE) { dt_max = SEGMENT_CRUISE_TIME_SCALE*DT_SEGMENT; }
+    #endif
     float dt = 0.0; // Initialize segment time
     float time_var = dt_max; // Time worker variable
     float mm_var; // mm-Distance worker variable
     float speed_var; // Speed worker variable
     float mm_remaining = pl_block->millimeters; // New segment distance from end of block.
     float minimum_mm = mm_remaining-prep.req_mm_increment; // Guarantee at least one step.
+    #ifdef STEP_RATE_RAMPS
+      float entry_speed = prep.current_speed;
+    #endif
     if (minimum_mm < 0.0) { minimum_mm = 0.0; }
+    #ifdef MOTOR_CURRENT_PROFILES
+      uint8_t current_phase = CURRENT_PHASE_RUN;
+    #endif
 
     do {
+      #ifdef MOTOR_CURRENT_PROFILES
+        if (prep.ramp_type != RAMP_CRUISE) { current_phase = CURRENT_PHASE_BOOST; }
+      #endif
       switch (prep.ramp_type) {
         case RAMP_DECEL_OVERRIDE:
           speed_var = pl_block->acceleration*time_var;
@@ -1228,6 +1506,10 @@ void st_prep_buffer()
           prep.current_speed = prep.exit_speed;
       }
       dt += time_var; // Add computed ramp time to total segment time.
+      #ifdef SEGMENT_CRUISE_TIME_SCALE
+        // A stretched cruise segment ends with the cruise, so the following ramp gets short segments.
+        if ((prep.ramp_type != RAMP_CRUISE) && (dt_max > DT_SEGMENT)) { dt_max = dt; }
+      #endif
       if (dt < dt_max) { time_var = dt_max - dt; } // **Incomplete** At ramp junction.
       else {
         if (mm_remaining > minimum_mm) { // Check for very slow segments with zero steps.
@@ -1261,6 +1543,9 @@ void st_prep_buffer()
       bit_false(sys.step_control,STEP_CONTROL_UPDATE_SPINDLE_PWM);
     }
     prep_segment->spindle_pwm = prep.current_spindle_pwm; // Reload segment PWM value
+    #ifdef MOTOR_CURRENT_PROFILES
+      prep_segment->current_phase = current_phase;
+    #endif
 
 
     /* -----------------------------------------------------------------------------------
@@ -1274,8 +1559,13 @@ void st_prep_buffer()
        supported by Grbl (i.e. exceeding 10 meters axis travel at 200 step/mm).
     */
     float step_dist_remaining = prep.step_per_mm*mm_remaining; // Convert mm_remaining to steps
-    float n_steps_remaining = ceil(step_dist_remaining); // Round-up current steps remaining
-    float last_n_steps_remaining = ceil(prep.steps_remaining); // Round-up last steps remaining
+    #ifdef SEGMENT_PREP_INTEGER_STEPS
+      uint32_t n_steps_remaining = st_ceil_steps(step_dist_remaining); // Round-up current steps remaining
+      uint32_t last_n_steps_remaining = prep.steps_remaining; // Already whole steps
+    #else
+      float n_steps_remaining = ceil(step_dist_remaining); // Round-up current steps remaining
+      float last_n_steps_remaining = ceil(prep.steps_remaining); // Round-up last steps remaining
+    #endif
     prep_segment->n_step = last_n_steps_remaining-n_steps_remaining; // Compute number of steps to execute.
 
     // Bail if we are at the end of a feed hold and don't have a step to execute.
@@ -1300,10 +1590,17 @@ void st_prep_buffer()
     // typically very small and do not adversely effect performance, but ensures that Grbl
     // outputs the exact acceleration and velocity profiles as computed by the planner.
     dt += prep.dt_remainder; // Apply previous segment partial step execute time
+    #ifdef SEGMENT_CRUISE_TIME_SCALE
+      prep_segment->duration = min(dt*SEGMENT_TIME_UNITS_PER_MINUTE, 0xffff);
+    #endif
     float inv_rate = dt/(last_n_steps_remaining - step_dist_remaining); // Compute adjusted step rate inverse
 
     // Compute CPU cycles per step for the prepped segment.
-    uint32_t cycles = ceil( (TICKS_PER_MICROSECOND*1000000*60)*inv_rate ); // (cycles/step)
+    #ifdef SEGMENT_PREP_INTEGER_STEPS
+      uint32_t cycles = st_ceil_steps( (TICKS_PER_MICROSECOND*1000000*60)*inv_rate ); // (cycles/step)
+    #else
+      uint32_t cycles = ceil( (TICKS_PER_MICROSECOND*1000000*60)*inv_rate ); // (cycles/step)
+    #endif
 
     #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
       // Compute step timing and multi-axis smoothing level.
@@ -1316,8 +1613,29 @@ void st_prep_buffer()
         cycles >>= prep_segment->amass_level;
         prep_segment->n_step <<= prep_segment->amass_level;
       }
+      // Scale the Bresenham axis increments here, rather than on segment load in the stepper ISR.
+      uint8_t idx;
+      for (idx=0; idx<N_AXIS; idx++) { prep_segment->steps[idx] = st_prep_block->steps[idx] >> prep_segment->amass_level; }
+      #ifdef LASER_RASTER
+        prep_segment->raster_steps = st_prep_block->raster_steps >> prep_segment->amass_level;
+      #endif
       if (cycles < (1UL << 16)) { prep_segment->cycles_per_tick = cycles; } // < 65536 (4.1ms @ 16MHz)
       else { prep_segment->cycles_per_tick = 0xffff; } // Just set the slowest speed possible.
+      #ifdef STEP_RATE_RAMPS
+        // Spread the segment rate into a ramp from its entry to its exit speed. The periods are
+        // inverse to the speeds at both ends and average the segment period, so the segment time is
+        // kept. Computed on the AMASS-scaled ISR ticks, so level changes between segments keep the rate.
+        prep_segment->cycles_delta = 0;
+        if ((prep_segment->n_step > 1) && (cycles < RAMP_MAX_CYCLES)) {
+          float speed_ratio = RAMP_MAX_SPEED_RATIO;
+          if (prep.current_speed*RAMP_MAX_SPEED_RATIO > entry_speed) {
+            speed_ratio = max(entry_speed/prep.current_speed, 1.0/RAMP_MAX_SPEED_RATIO);
+          }
+          float entry_cycles = (2.0*cycles)/(1.0+speed_ratio);
+          prep_segment->cycles_per_tick = entry_cycles;
+          prep_segment->cycles_delta = lround((65536.0*2.0)*((float)cycles-prep_segment->cycles_per_tick)/(prep_segment->n_step-1));
+        }
+      #endif
     #else
       // Compute step timing and timer prescalar for normal step generation.
       if (cycles < (1UL << 16)) { // < 65536  (4.1ms @ 16MHz)
@@ -1365,6 +1683,9 @@ void st_prep_buffer()
         }
         pl_block = NULL; // Set pointer to indicate check and load next planner block.
         plan_discard_current_block();
+        #ifdef ENABLE_PERFORMANCE_COUNTERS
+          if ((sys.state == STATE_CYCLE) && (plan_get_current_block() == NULL)) { perf.planner_empty++; }
+        #endif
       }
     }
 
@@ -1372,6 +1693,20 @@ void st_prep_buffer()
 }
 
 
+#ifdef ENABLE_JOB_CHECKPOINT
+  // Returns the line number of the last numbered block the stepper ISR started executing.
+  int32_t st_get_exec_line_number()
+  {
+    int32_t line_number;
+    uint8_t sreg = SREG;
+    cli();
+    line_number = st.exec_line_number;
+    SREG = sreg;
+    return(line_number);
+  }
+#endif
+
+
 // Called by realtime status reporting to fetch the current speed being executed. This value
 // however is not exactly the current speed, but the speed computed in the last step segment
 // in the segment buffer. It will always be behind by up to the number of segment blocks (-1)
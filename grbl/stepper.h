@@ -56,4 +56,14 @@ void st_update_plan_block_parameters();
 // Called by realtime status reporting if realtime rate reporting is enabled in config.h.
 float st_get_realtime_rate();
 
+#ifdef MOTOR_CURRENT_PROFILES
+  // Returns the highest motor current phase of the buffered and executing segments.
+  uint8_t st_get_current_phase();
+#endif
+
+#ifdef ENABLE_JOB_CHECKPOINT
+  // Returns the line number of the last numbered block the stepper ISR started executing.
+  int32_t st_get_exec_line_number();
+#endif
+
 #endif
@@ -115,7 +115,7 @@ uint8_t system_execute_line(char *line)
   uint8_t helper_var = 0; // Helper variable
   float parameter, value;
   switch( line[char_counter] ) {
-    case 0 : report_grbl_help(); break;
+    case 0 : report_start(REPORT_HELP); break;
     case 'J' : // Jogging
       // Execute only if in IDLE or JOG states.
       if (sys.state != STATE_IDLE && sys.state != STATE_JOG) { return(STATUS_IDLE_ERROR); }
@@ -127,11 +127,11 @@ uint8_t system_execute_line(char *line)
       switch( line[1] ) {
         case '$' : // Prints Grbl settings
           if ( sys.state & (STATE_CYCLE | STATE_HOLD) ) { return(STATUS_IDLE_ERROR); } // Block during cycle. Takes too long to print.
-          else { report_grbl_settings(); }
+          else { report_start(REPORT_SETTINGS); }
           break;
         case 'G' : // Prints gcode parser state
           // TODO: Move this to realtime commands for GUIs to request this data during suspend-state.
-          report_gcode_modes();
+          report_start(REPORT_GCODE_MODES);
           break;
         case 'C' : // Set check g-code mode [IDLE/CHECK]
           // Perform reset when toggling off. Check g-code mode should only work if Grbl
@@ -157,13 +157,52 @@ uint8_t system_execute_line(char *line)
           break;
       }
       break;
+    #ifdef ENABLE_PERFORMANCE_COUNTERS
+      case 'P' : // Print or clear performance counters. Allowed in any state to profile a running job.
+        if (line[2] == 0) { report_perf_counters(); }
+        else if ((line[2] == 'R') && (line[3] == 0)) { perf_reset(); }
+        else { return(STATUS_INVALID_STATEMENT); }
+        break;
+    #endif
+    #ifdef ENABLE_JOB_CHECKPOINT
+      case 'K' : // Print job checkpoint, or replay a job up to a line number [IDLE]
+        if (line[2] == 0) { report_checkpoint(); }
+        else {
+          if (line[2] != '=') { return(STATUS_INVALID_STATEMENT); }
+          char_counter = 3;
+          if (!read_float(line, &char_counter, &value)) { return(STATUS_BAD_NUMBER_FORMAT); }
+          if ((line[char_counter] != 0) || (value < 1.0)) { return(STATUS_INVALID_STATEMENT); }
+          return(checkpoint_replay(trunc(value)));
+        }
+        break;
+    #endif
+    #ifdef INDEXER_AXIS
+      case 'E' : // Move the indexer axis, or wait for it [IDLE/CYCLE/HOLD/JOG]
+        if (sys.state & (STATE_ALARM | STATE_SAFETY_DOOR | STATE_SLEEP)) { return(STATUS_IDLE_ERROR); }
+        if (line[2] == 0) { indexer_synchronize(); }
+        else {
+          if (line[2] != '=') { return(STATUS_INVALID_STATEMENT); }
+          char_counter = 3;
+          if (!read_float(line, &char_counter, &value)) { return(STATUS_BAD_NUMBER_FORMAT); }
+          parameter = 0.0; // Axis maximum rate.
+          if (line[char_counter] == 'F') {
+            char_counter++;
+            if (!read_float(line, &char_counter, &parameter)) { return(STATUS_BAD_NUMBER_FORMAT); }
+            if (parameter < 0.0) { return(STATUS_NEGATIVE_VALUE); }
+          }
+          if (line[char_counter] != 0) { return(STATUS_INVALID_STATEMENT); }
+          if (sys.state == STATE_CHECK_MODE) { return(STATUS_OK); }
+          return(indexer_queue_move(value, parameter));
+        }
+        break;
+    #endif
     default :
       // Block any system command that requires the state as IDLE/ALARM. (i.e. EEPROM, homing)
       if ( !(sys.state == STATE_IDLE || sys.state == STATE_ALARM) ) { return(STATUS_IDLE_ERROR); }
       switch( line[1] ) {
         case '#' : // Print Grbl NGC parameters
           if ( line[2] != 0 ) { return(STATUS_INVALID_STATEMENT); }
-          else { report_ngc_parameters(); }
+          else { report_start(REPORT_NGC_PARAMETERS); }
           break;
         case 'H' : // Perform homing cycle [IDLE/ALARM]
           if (bit_isfalse(settings.flags,BITFLAG_HOMING_ENABLE)) {return(STATUS_SETTING_DISABLED); }
@@ -235,8 +274,7 @@ uint8_t system_execute_line(char *line)
           break;
         case 'I' : // Print or store build info. [IDLE/ALARM]
           if ( line[++char_counter] == 0 ) {
-            settings_read_build_info(line);
-            report_build_info(line);
+            report_start(REPORT_BUILD_INFO);
           #ifdef ENABLE_BUILD_INFO_WRITE_COMMAND
             } else { // Store startup line [IDLE/ALARM]
               if(line[char_counter++] != '=') { return(STATUS_INVALID_STATEMENT); }
@@ -267,13 +305,7 @@ uint8_t system_execute_line(char *line)
           break;
         case 'N' : // Startup lines. [IDLE/ALARM]
           if ( line[++char_counter] == 0 ) { // Print startup lines
-            for (helper_var=0; helper_var < N_STARTUP_LINE; helper_var++) {
-              if (!(settings_read_startup_line(helper_var, line))) {
-                report_status_message(STATUS_SETTING_READ_FAIL);
-              } else {
-                report_startup_line(helper_var,line);
-              }
-            }
+            report_start(REPORT_STARTUP_LINES);
             break;
           } else { // Store startup line [IDLE Only] Prevents motion during ALARM.
             if (sys.state != STATE_IDLE) { return(STATUS_IDLE_ERROR); } // Store only when idle.
@@ -368,7 +400,8 @@ uint8_t system_check_travel_limits(float *target)
   uint8_t idx;
   for (idx=0; idx<N_AXIS; idx++) {
     // Ignore soft limit if AXIS_MAX_TRAVEL == 0 (parameter $130 to $135)
-    if (settings.max_travel[idx] != 0) {
+    // NOTE: Wrapped rotary axes turn endlessly and have no travel limits.
+    if ((settings.max_travel[idx] != 0) && bit_isfalse(settings.rotary_wrap_mask,bit(idx))) {
       #ifdef HOMING_FORCE_SET_ORIGIN
         // When homing forced set origin is enabled, soft limits checks need to account for directionality.
         // NOTE: max_travel is stored as negative
@@ -0,0 +1,494 @@
+/*
+  estimator.c - host-side g-code job time estimator built from the Grbl firmware sources
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  The estimator runs the unmodified g-code parser, motion control, planner and step segment
+  generator on the host and emulates only the hardware around them. Build it with 'make estimator'.
+
+    build/estimator [-s settings.txt] [-b lines] [-n count] [-d segments.txt] [-v] job.nc
+
+  -s  Applies a '$$' settings dump on top of the compiled defaults.
+  -b  Reports time per range of this many lines. Default 1000.
+  -n  Lists at most this many lines that failed to reach their programmed feed. Default 20.
+  -d  Writes the step count, timer period and AMASS level or prescaler of every executed segment to
+      this file, one segment per line. Builds with different segment generator options can be
+      compared with it. See the 'segment_diff' make target.
+  -v  Echoes Grbl's serial output to stderr.
+
+  Time comes from the stepper interrupt itself. Whenever the firmware waits for the planner buffer
+  to drain, the estimator calls the Timer1 compare interrupt directly and accumulates the timer
+  period it programmed, exactly as the hardware would count it. Lines are streamed as fast as
+  Grbl accepts them, like a host that never starves the planner.
+    The firmware's wait loops in other modules are redirected here with the linker's --wrap
+  option. stepper.c and planner.c are included into this file to read their private state: the
+  executing block, for attributing time to lines and tools, and each block's planned speeds, for
+  finding where the programmed feed is not reached.
+  NOTE: Soft and hard limits are disabled, since their alarms wait for a reset that never comes.
+  Probing cycles can't trigger and end the estimate with an alarm. '$' lines are skipped.
+*/
+
+#include "grbl.h"
+#include <stdio.h>
+#include <unistd.h>
+
+#include "stepper.c"
+#include "planner.c"
+
+
+// Register file stand-in. See avr/io.h.
+#define AVR_DEFINE_8(r) volatile uint8_t r;
+#define AVR_DEFINE_16(r) volatile uint16_t r;
+AVR_REGISTERS_8(AVR_DEFINE_8)
+AVR_REGISTERS_16(AVR_DEFINE_16)
+
+// System globals normally declared in main.c.
+system_t sys;
+int32_t sys_position[N_AXIS];
+int32_t sys_probe_position[N_AXIS];
+volatile uint8_t sys_probe_state;
+volatile uint8_t sys_rt_exec_state;
+volatile uint8_t sys_rt_exec_alarm;
+volatile uint8_t sys_rt_exec_motion_override;
+volatile uint8_t sys_rt_exec_accessory_override;
+uint8_t axis_X_mask, axis_Y_mask, axis_Z_mask, axis_A_mask, axis_B_mask, axis_C_mask;
+uint8_t axis_U_mask, axis_V_mask, axis_W_mask;
+#ifdef DEBUG
+  volatile uint8_t sys_rt_exec_debug;
+#endif
+
+// Firmware entry points redirected by the linker.
+void __real_protocol_execute_realtime();
+uint8_t __real_plan_buffer_line(float *target, plan_line_data_t *pl_data);
+
+#define EST_FEED_REACHED_RATIO 0.99 // Peak speeds below this fraction of the programmed rate are reported.
+#define EST_QUEUE_SIZE 64 // Power of two. Must hold the planner and segment buffer blocks.
+
+// Tracks each planner block from when it is queued until it has been executed.
+typedef struct {
+  plan_block_t *block;
+  uint32_t line;
+  uint8_t tool;
+  float millimeters; // Block length as queued. The segment generator counts the planner copy down.
+} est_block_t;
+static est_block_t est_queue[EST_QUEUE_SIZE];
+static uint16_t est_queue_head;     // Next entry to queue.
+static uint16_t est_queue_prepped;  // Oldest entry still in the planner buffer.
+static uint16_t est_queue_exec;     // Next entry to start executing.
+static est_block_t *est_exec_block; // Entry the stepper is executing. NULL if none yet.
+static uint8_t est_exec_block_index;
+
+typedef struct {
+  double seconds;
+  float programmed_rate; // Worst block of the line that failed to reach its programmed rate.
+  float peak_rate;
+} est_line_t;
+static est_line_t *est_lines;
+static uint32_t est_line_count;
+static uint32_t est_line_capacity;
+static uint32_t est_current_line;
+static uint8_t est_current_tool; // Last T word. The parser only keeps it for the line that has it.
+
+static double est_total_seconds;
+static double est_tool_seconds[256];
+static uint32_t est_block_count;
+static uint8_t est_verbose;
+static FILE *est_segment_file;
+
+
+static est_line_t *est_line(uint32_t line)
+{
+  if (line >= est_line_capacity) {
+    uint32_t capacity = (est_line_capacity ? 2*est_line_capacity : 4096);
+    while (capacity <= line) { capacity *= 2; }
+    est_lines = realloc(est_lines, capacity*sizeof(est_line_t));
+    if (est_lines == NULL) { fprintf(stderr, "estimator: out of memory\n"); exit(1); }
+    memset(&est_lines[est_line_capacity], 0, (capacity-est_line_capacity)*sizeof(est_line_t));
+    est_line_capacity = capacity;
+  }
+  if (line >= est_line_count) { est_line_count = line+1; }
+  return(&est_lines[line]);
+}
+
+
+static void est_add_time(double seconds, uint32_t line, uint8_t tool)
+{
+  est_total_seconds += seconds;
+  est_tool_seconds[tool] += seconds;
+  est_line(line)->seconds += seconds;
+}
+
+
+// Computes the peak speed of blocks the segment generator has finished with. The planner no longer
+// changes their entry speeds, and their memory is intact until the next block is queued.
+static void est_track_prepped_blocks()
+{
+  uint16_t queued = est_queue_head - est_queue_prepped;
+  uint8_t discarded = queued - plan_get_block_buffer_count();
+  while (discarded--) {
+    est_block_t *entry = &est_queue[est_queue_prepped % EST_QUEUE_SIZE];
+    est_queue_prepped++;
+    plan_block_t *block = entry->block;
+    float exit_speed_sqr = 0.0;
+    if (est_queue_prepped != est_queue_head) {
+      exit_speed_sqr = est_queue[est_queue_prepped % EST_QUEUE_SIZE].block->entry_speed_sqr;
+    }
+    float nominal_speed = plan_compute_profile_nominal_speed(block);
+    float peak_speed_sqr = 0.5*(block->entry_speed_sqr + exit_speed_sqr) + block->acceleration*entry->millimeters;
+    float peak_speed = min(nominal_speed, sqrt(peak_speed_sqr));
+    if (peak_speed < EST_FEED_REACHED_RATIO*block->programmed_rate) {
+      est_line_t *line = est_line(entry->line);
+      if ((line->programmed_rate == 0.0) ||
+          (peak_speed/block->programmed_rate < line->peak_rate/line->programmed_rate)) {
+        line->programmed_rate = block->programmed_rate;
+        line->peak_rate = peak_speed;
+      }
+    }
+  }
+}
+
+
+// Emulates the stepper interrupt until the executing segment completes or the steppers go idle.
+static void est_run_stepper()
+{
+  while (TIMSK1 & (1<<OCIE1A)) {
+    uint8_t segment_loaded = (st.exec_segment == NULL);
+    TIMER1_COMPA_vect();
+    if (!(TIMSK1 & (1<<OCIE1A))) { break; } // Segment buffer ran empty. Cycle stopped.
+    if (segment_loaded && (est_segment_file != NULL)) {
+      #ifdef ADAPTIVE_MULTI_AXIS_STEP_SMOOTHING
+        fprintf(est_segment_file, "%u %u %u\n", st.exec_segment->n_step,
+          st.exec_segment->cycles_per_tick, st.exec_segment->amass_level);
+      #else
+        fprintf(est_segment_file, "%u %u %u\n", st.exec_segment->n_step,
+          st.exec_segment->cycles_per_tick, st.exec_segment->prescaler);
+      #endif
+    }
+
+    // A changed stepper block index marks the start of the next planner block.
+    if (st.exec_block_index != est_exec_block_index) {
+      est_exec_block_index = st.exec_block_index;
+      est_exec_block = &est_queue[est_queue_exec % EST_QUEUE_SIZE];
+      est_queue_exec++;
+    }
+
+    // The interrupt has programmed the period until it fires again.
+    uint16_t prescaler;
+    switch (TCCR1B & ((1<<CS12)|(1<<CS11)|(1<<CS10))) {
+      case (1<<CS11): prescaler = 8; break;
+      case ((1<<CS11)|(1<<CS10)): prescaler = 64; break;
+      default: prescaler = 1;
+    }
+    double seconds = ((uint32_t)OCR1A+1)*prescaler/(double)F_CPU;
+    if (est_exec_block != NULL) { est_add_time(seconds, est_exec_block->line, est_exec_block->tool); }
+    else { est_add_time(seconds, est_current_line, est_current_tool); }
+
+    if (st.exec_segment == NULL) { break; } // Let the firmware prepare the next segment.
+  }
+}
+
+
+void __wrap_protocol_execute_realtime()
+{
+  __real_protocol_execute_realtime();
+  est_track_prepped_blocks();
+  est_run_stepper();
+}
+
+
+// Same as the firmware, but waits through the redirected realtime executor.
+void __wrap_protocol_buffer_synchronize()
+{
+  protocol_auto_cycle_start();
+  do {
+    __wrap_protocol_execute_realtime();
+    if (sys.abort) { return; }
+  } while (plan_get_current_block() || (sys.state == STATE_CYCLE));
+}
+
+
+void __wrap_mc_dwell(float seconds)
+{
+  if (sys.state == STATE_CHECK_MODE) { return; }
+  __wrap_protocol_buffer_synchronize();
+  est_add_time(seconds, est_current_line, est_current_tool);
+}
+
+
+uint8_t __wrap_plan_buffer_line(float *target, plan_line_data_t *pl_data)
+{
+  uint8_t block_count = plan_get_block_buffer_count();
+  uint8_t plan_status = __real_plan_buffer_line(target, pl_data);
+  if (plan_get_block_buffer_count() != block_count) {
+    est_block_t *entry = &est_queue[est_queue_head % EST_QUEUE_SIZE];
+    entry->block = &block_buffer[plan_prev_block_index(block_buffer_head)];
+    entry->line = est_current_line;
+    entry->tool = est_current_tool;
+    entry->millimeters = entry->block->millimeters;
+    est_queue_head++;
+    est_block_count++;
+  }
+  return(plan_status);
+}
+
+
+// Serial port stand-in. Output is discarded unless verbose, and the firmware never reads input.
+void serial_init() { }
+void serial_write(uint8_t data) { if (est_verbose) { fputc(data, stderr); } }
+void serial_write_buffer(const uint8_t *data, uint8_t length) { while (length--) { serial_write(*data++); } }
+uint8_t serial_write_reserve(uint8_t length) { return(length); }
+void serial_write_reserved(uint8_t data) { serial_write(data); }
+void serial_write_commit() { }
+void serial_putstring(char *StringPtr) { while (*StringPtr) { serial_write(*StringPtr++); } }
+uint8_t serial_read() { return(SERIAL_NO_DATA); }
+void serial_reset_read_buffer() { }
+uint8_t serial_get_rx_buffer_available() { return(RX_BUFFER_SIZE); }
+uint8_t serial_get_rx_buffer_count() { return(0); }
+uint16_t serial_get_rx_overrun_count() { return(0); }
+uint8_t serial_get_tx_buffer_count() { return(0); }
+uint8_t serial_get_tx_buffer_available() { return(TX_BUFFER_SIZE); }
+#ifdef ENABLE_RX_LINE_ASSEMBLY
+  char *serial_get_line(char *line) { return(NULL); }
+  void serial_release_line() { }
+#endif
+
+
+// EEPROM stand-in. Starts erased, so settings initialize to the compiled defaults.
+static unsigned char est_eeprom[4096];
+
+unsigned char eeprom_get_char(unsigned int addr) { return(est_eeprom[addr % sizeof(est_eeprom)]); }
+void eeprom_put_char(unsigned int addr, unsigned char new_value) { est_eeprom[addr % sizeof(est_eeprom)] = new_value; }
+
+void memcpy_to_eeprom_with_checksum(unsigned int destination, char *source, unsigned int size) {
+  unsigned char checksum = 0;
+  for(; size > 0; size--) {
+    checksum = (checksum != 0); // Same arithmetic as the firmware's (checksum << 1) || (checksum >> 7).
+    checksum += *source;
+    eeprom_put_char(destination++, *(source++));
+  }
+  eeprom_put_char(destination, checksum);
+}
+
+int memcpy_from_eeprom_with_checksum(char *destination, unsigned int source, unsigned int size) {
+  unsigned char data, checksum = 0;
+  for(; size > 0; size--) {
+    data = eeprom_get_char(source++);
+    checksum = (checksum != 0);
+    checksum += data;
+    *(destination++) = data;
+  }
+  return(checksum == eeprom_get_char(source));
+}
+
+
+// Filters a line the same way the protocol module does. Returns false on a line overflow.
+static uint8_t est_filter_line(const char *in, char *line)
+{
+  uint8_t char_counter = 0;
+  uint8_t comment = 0;
+  char c;
+  for (; (c = *in) != 0; in++) {
+    if ((c == '\n') || (c == '\r')) { break; }
+    if (comment) {
+      if ((c == ')') && (comment == '(')) { comment = 0; }
+    } else if (c <= ' ') {
+    } else if (c == '/') {
+    } else if ((c == '(') || (c == ';')) {
+      comment = c;
+    } else if (char_counter >= (LINE_BUFFER_SIZE-1)) {
+      return(false);
+    } else if (c >= 'a' && c <= 'z') {
+      line[char_counter++] = c-'a'+'A';
+    } else {
+      line[char_counter++] = c;
+    }
+  }
+  line[char_counter] = 0;
+  return(true);
+}
+
+
+// Updates the current tool from a T word in a filtered line.
+static void est_parse_tool(char *line)
+{
+  uint8_t char_counter = 0;
+  float value;
+  while (line[char_counter] != 0) {
+    char letter = line[char_counter++];
+    if (!read_float(line, &char_counter, &value)) { return; } // Parser reports the error.
+    if ((letter == 'T') && (value >= 0.0) && (value <= 255)) { est_current_tool = trunc(value); }
+  }
+}
+
+
+static void est_load_settings(const char *path)
+{
+  FILE *file = fopen(path, "r");
+  if (file == NULL) { perror(path); exit(1); }
+  char buffer[1024], line[LINE_BUFFER_SIZE];
+  while (fgets(buffer, sizeof(buffer), file) != NULL) {
+    if (!est_filter_line(buffer, line) || (line[0] != '$') || (line[1] == 0)) { continue; }
+    uint8_t status = system_execute_line(line);
+    if (status != STATUS_OK) { fprintf(stderr, "estimator: %s: error:%d\n", line, status); }
+  }
+  fclose(file);
+}
+
+
+static void est_print_time(const char *label, double seconds)
+{
+  uint32_t whole = (uint32_t)seconds;
+  printf("%-16s %4u:%02u:%04.1f  %10.1f s\n", label, whole/3600, (whole/60)%60,
+    seconds-60.0*(whole/60), seconds);
+}
+
+
+int main(int argc, char *argv[])
+{
+  const char *settings_path = NULL;
+  uint32_t bucket = 1000;
+  uint32_t max_listed = 20;
+  int opt;
+  while ((opt = getopt(argc, argv, "s:b:n:d:v")) != -1) {
+    switch (opt) {
+      case 's': settings_path = optarg; break;
+      case 'b': bucket = strtoul(optarg, NULL, 10); break;
+      case 'n': max_listed = strtoul(optarg, NULL, 10); break;
+      case 'd':
+        est_segment_file = fopen(optarg, "w");
+        if (est_segment_file == NULL) { perror(optarg); return(1); }
+        break;
+      case 'v': est_verbose = true; break;
+      default:
+        fprintf(stderr, "usage: %s [-s settings.txt] [-b lines] [-n count] [-d segments.txt] [-v] job.nc\n", argv[0]);
+        return(1);
+    }
+  }
+  if ((optind != argc-1) || (bucket == 0)) {
+    fprintf(stderr, "usage: %s [-s settings.txt] [-b lines] [-n count] [-d segments.txt] [-v] job.nc\n", argv[0]);
+    return(1);
+  }
+  FILE *job = fopen(argv[optind], "r");
+  if (job == NULL) { perror(argv[optind]); return(1); }
+
+  // Bring up the firmware as main() does. Cleared registers read as idle inputs.
+  memset(est_eeprom, 0xff, sizeof(est_eeprom));
+  SPSR = (1<<SPIF); // Let any SPI transfer complete immediately.
+  settings_init();
+  const char axis_names[N_AXIS] = { AXIS_1_NAME, AXIS_2_NAME, AXIS_3_NAME,
+    #if N_AXIS > 3
+      AXIS_4_NAME,
+    #endif
+    #if N_AXIS > 4
+      AXIS_5_NAME,
+    #endif
+    #if N_AXIS > 5
+      AXIS_6_NAME,
+    #endif
+  };
+  uint8_t axis;
+  for (axis=0; axis<N_AXIS; axis++) { // Axis masks by name. Rotary axes are named A, B or C.
+    switch (axis_names[axis]) {
+      case 'X': axis_X_mask |= bit(axis); break;
+      case 'Y': axis_Y_mask |= bit(axis); break;
+      case 'Z': axis_Z_mask |= bit(axis); break;
+      case 'A': axis_A_mask |= bit(axis); break;
+      case 'B': axis_B_mask |= bit(axis); break;
+      case 'C': axis_C_mask |= bit(axis); break;
+    }
+  }
+  stepper_init();
+  system_init();
+  sys.state = STATE_IDLE;
+  sys.f_override = DEFAULT_FEED_OVERRIDE;
+  sys.r_override = DEFAULT_RAPID_OVERRIDE;
+  sys.spindle_speed_ovr = DEFAULT_SPINDLE_SPEED_OVERRIDE;
+  gc_init();
+  spindle_init();
+  coolant_init();
+  limits_init();
+  probe_init();
+  plan_reset();
+  st_reset();
+  plan_sync_position();
+  gc_sync_position();
+
+  if (settings_path != NULL) { est_load_settings(settings_path); }
+  settings.flags &= ~(BITFLAG_SOFT_LIMIT_ENABLE|BITFLAG_HARD_LIMIT_ENABLE);
+  st_generate_step_dir_invert_masks();
+
+  // Stream the job. Line numbers are counted from one, as in an editor.
+  static char buffer[65536];
+  char line[LINE_BUFFER_SIZE];
+  while (fgets(buffer, sizeof(buffer), job) != NULL) {
+    est_current_line++;
+    est_line(est_current_line);
+    if (!est_filter_line(buffer, line)) {
+      fprintf(stderr, "estimator: line %u: error:%d\n", est_current_line, STATUS_OVERFLOW);
+      continue;
+    }
+    if ((line[0] == 0) || (line[0] == '$') || (line[0] == '%')) { continue; }
+    est_parse_tool(line);
+    uint8_t status = gc_execute_line(line);
+    if (status != STATUS_OK) { fprintf(stderr, "estimator: line %u: error:%d\n", est_current_line, status); }
+    if (sys.abort) {
+      fprintf(stderr, "estimator: line %u: alarm. Estimate stops here.\n", est_current_line);
+      break;
+    }
+  }
+  fclose(job);
+  __wrap_protocol_buffer_synchronize();
+  if (est_segment_file != NULL) { fclose(est_segment_file); }
+
+  // Report.
+  printf("%u lines, %u motion blocks\n", est_current_line, est_block_count);
+  est_print_time("Total", est_total_seconds);
+
+  printf("\nTime per tool:\n");
+  uint16_t tool;
+  char label[32];
+  for (tool=0; tool<256; tool++) {
+    if (est_tool_seconds[tool] > 0.0) {
+      snprintf(label, sizeof(label), "  T%u", tool);
+      est_print_time(label, est_tool_seconds[tool]);
+    }
+  }
+
+  printf("\nTime per %u lines:\n", bucket);
+  uint32_t idx, first;
+  for (first=1; first<est_line_count; first+=bucket) {
+    double seconds = 0.0;
+    for (idx=first; (idx<first+bucket) && (idx<est_line_count); idx++) { seconds += est_lines[idx].seconds; }
+    snprintf(label, sizeof(label), "  %u-%u", first, idx-1);
+    est_print_time(label, seconds);
+  }
+
+  uint32_t shortfalls = 0;
+  for (idx=1; idx<est_line_count; idx++) {
+    if (est_lines[idx].programmed_rate > 0.0) { shortfalls++; }
+  }
+  printf("\nLines that don't reach their programmed feed: %u\n", shortfalls);
+  uint32_t listed = 0;
+  for (idx=1; (idx<est_line_count) && (listed<max_listed); idx++) {
+    if (est_lines[idx].programmed_rate > 0.0) {
+      printf("  line %u: peak %.0f of %.0f mm/min\n", idx, est_lines[idx].peak_rate, est_lines[idx].programmed_rate);
+      listed++;
+    }
+  }
+  if (listed < shortfalls) { printf("  ... %u more\n", shortfalls-listed); }
+  return(0);
+}
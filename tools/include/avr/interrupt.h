@@ -0,0 +1,16 @@
+/*
+  avr/interrupt.h - host stand-in for interrupt control
+  Part of the Grbl host tools
+*/
+
+#ifndef avr_interrupt_h
+#define avr_interrupt_h
+
+// Interrupt handlers become plain functions, which the host tools call to emulate the hardware.
+// The tools are single-threaded, so there is nothing to mask.
+#define ISR(vector, ...) void vector(void)
+#define ISR_NOBLOCK
+#define sei()
+#define cli()
+
+#endif
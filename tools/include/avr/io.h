@@ -0,0 +1,265 @@
+/*
+  avr/io.h - host stand-in for the ATmega2560 register file
+  Part of the Grbl host tools
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Registers are plain variables, so the firmware sources compile and run unmodified on the host.
+// Bit positions match the ATmega2560 datasheet. Each tool defines the variables it links against.
+
+#ifndef avr_io_h
+#define avr_io_h
+
+#include <stdint.h>
+
+#define AVR_REGISTERS_8(R) \
+  R(DDRA) R(PORTA) R(PINA) R(DDRB) R(PORTB) R(PINB) R(DDRC) R(PORTC) R(PINC) R(DDRD) R(PORTD) \
+  R(PIND) R(DDRE) R(PORTE) R(PINE) R(DDRF) R(PORTF) R(PINF) R(DDRG) R(PORTG) R(PING) R(DDRH) \
+  R(PORTH) R(PINH) R(DDRJ) R(PORTJ) R(PINJ) R(DDRK) R(PORTK) R(PINK) R(DDRL) R(PORTL) R(PINL) \
+  R(TCCR0A) R(TCCR0B) R(TIMSK0) R(TIFR0) R(TCNT0) R(OCR0A) R(OCR0B) R(TCCR1A) R(TCCR1B) R(TIMSK1) \
+  R(TIFR1) R(TCCR1C) R(TCCR2A) R(TCCR2B) R(TIMSK2) R(TIFR2) R(TCNT2) R(OCR2A) R(OCR2B) R(TCCR3A) \
+  R(TCCR3B) R(TIMSK3) R(TIFR3) R(TCCR3C) R(TCCR4A) R(TCCR4B) R(TIMSK4) R(TIFR4) R(TCCR4C) R(TCCR5A) \
+  R(TCCR5B) R(TIMSK5) R(TIFR5) R(TCCR5C) R(UCSR0A) R(UCSR0B) R(UCSR0C) R(UBRR0H) R(UBRR0L) R(UDR0) \
+  R(EECR) R(EEDR) R(SPCR) R(SPSR) R(SPDR) R(PCICR) R(PCIFR) R(PCMSK0) R(PCMSK1) R(PCMSK2) R(EICRA) \
+  R(EICRB) R(EIMSK) R(EIFR) R(SREG) R(MCUSR) R(WDTCSR)
+
+#define AVR_REGISTERS_16(R) \
+  R(TCNT1) R(OCR1A) R(OCR1B) R(OCR1C) R(ICR1) R(TCNT3) R(OCR3A) R(OCR3B) R(OCR3C) R(ICR3) R(TCNT4) \
+  R(OCR4A) R(OCR4B) R(OCR4C) R(ICR4) R(TCNT5) R(OCR5A) R(OCR5B) R(OCR5C) R(ICR5) R(EEAR) R(UBRR0)
+
+#define AVR_DECLARE_8(r) extern volatile uint8_t r;
+#define AVR_DECLARE_16(r) extern volatile uint16_t r;
+AVR_REGISTERS_8(AVR_DECLARE_8)
+AVR_REGISTERS_16(AVR_DECLARE_16)
+
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define WGM00 0
+#define WGM01 1
+#define WGM02 3
+#define COM0A1 7
+#define COM0A0 6
+#define COM0B1 5
+#define COM0B0 4
+#define TOIE0 0
+#define OCIE0A 1
+#define OCIE0B 2
+#define TOV0 0
+#define OCF0A 1
+#define OCF0B 2
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM10 0
+#define WGM11 1
+#define WGM12 3
+#define WGM13 4
+#define ICES1 6
+#define ICNC1 7
+#define COM1A1 7
+#define COM1A0 6
+#define COM1B1 5
+#define COM1B0 4
+#define COM1C1 3
+#define COM1C0 2
+#define TOIE1 0
+#define OCIE1A 1
+#define OCIE1B 2
+#define OCIE1C 3
+#define ICIE1 5
+#define TOV1 0
+#define OCF1A 1
+#define OCF1B 2
+#define OCF1C 3
+#define ICF1 5
+#define CS20 0
+#define CS21 1
+#define CS22 2
+#define WGM20 0
+#define WGM21 1
+#define WGM22 3
+#define COM2A1 7
+#define COM2A0 6
+#define COM2B1 5
+#define COM2B0 4
+#define TOIE2 0
+#define OCIE2A 1
+#define OCIE2B 2
+#define TOV2 0
+#define OCF2A 1
+#define OCF2B 2
+#define CS30 0
+#define CS31 1
+#define CS32 2
+#define WGM30 0
+#define WGM31 1
+#define WGM32 3
+#define WGM33 4
+#define ICES3 6
+#define ICNC3 7
+#define COM3A1 7
+#define COM3A0 6
+#define COM3B1 5
+#define COM3B0 4
+#define COM3C1 3
+#define COM3C0 2
+#define TOIE3 0
+#define OCIE3A 1
+#define OCIE3B 2
+#define OCIE3C 3
+#define ICIE3 5
+#define TOV3 0
+#define OCF3A 1
+#define OCF3B 2
+#define OCF3C 3
+#define ICF3 5
+#define CS40 0
+#define CS41 1
+#define CS42 2
+#define WGM40 0
+#define WGM41 1
+#define WGM42 3
+#define WGM43 4
+#define ICES4 6
+#define ICNC4 7
+#define COM4A1 7
+#define COM4A0 6
+#define COM4B1 5
+#define COM4B0 4
+#define COM4C1 3
+#define COM4C0 2
+#define TOIE4 0
+#define OCIE4A 1
+#define OCIE4B 2
+#define OCIE4C 3
+#define ICIE4 5
+#define TOV4 0
+#define OCF4A 1
+#define OCF4B 2
+#define OCF4C 3
+#define ICF4 5
+#define CS50 0
+#define CS51 1
+#define CS52 2
+#define WGM50 0
+#define WGM51 1
+#define WGM52 3
+#define WGM53 4
+#define ICES5 6
+#define ICNC5 7
+#define COM5A1 7
+#define COM5A0 6
+#define COM5B1 5
+#define COM5B0 4
+#define COM5C1 3
+#define COM5C0 2
+#define TOIE5 0
+#define OCIE5A 1
+#define OCIE5B 2
+#define OCIE5C 3
+#define ICIE5 5
+#define TOV5 0
+#define OCF5A 1
+#define OCF5B 2
+#define OCF5C 3
+#define ICF5 5
+#define MPCM0 0
+#define U2X0 1
+#define UPE0 2
+#define DOR0 3
+#define FE0 4
+#define UDRE0 5
+#define TXC0 6
+#define RXC0 7
+#define TXB80 0
+#define RXB80 1
+#define UCSZ02 2
+#define TXEN0 3
+#define RXEN0 4
+#define UDRIE0 5
+#define TXCIE0 6
+#define RXCIE0 7
+#define UCSZ00 1
+#define UCSZ01 2
+#define EERE 0
+#define EEPE 1
+#define EEWE 1
+#define EEMPE 2
+#define EEMWE 2
+#define EERIE 3
+#define SPR0 0
+#define SPR1 1
+#define CPHA 2
+#define CPOL 3
+#define MSTR 4
+#define DORD 5
+#define SPE 6
+#define SPIE 7
+#define SPI2X 0
+#define WCOL 6
+#define SPIF 7
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+#define PCIF0 0
+#define PCIF1 1
+#define PCIF2 2
+#define WDP0 0
+#define WDP1 1
+#define WDP2 2
+#define WDE 3
+#define WDCE 4
+#define WDP3 5
+#define WDIE 6
+#define WDIF 7
+#define PORF 0
+#define EXTRF 1
+#define BORF 2
+#define WDRF 3
+#define PCINT0 0
+#define PCINT1 1
+#define PCINT2 2
+#define PCINT3 3
+#define PCINT4 4
+#define PCINT5 5
+#define PCINT6 6
+#define PCINT7 7
+#define PCINT8 0
+#define PCINT9 1
+#define PCINT10 2
+#define PCINT11 3
+#define PCINT12 4
+#define PCINT13 5
+#define PCINT14 6
+#define PCINT15 7
+#define PCINT16 0
+#define PCINT17 1
+#define PCINT18 2
+#define PCINT19 3
+#define PCINT20 4
+#define PCINT21 5
+#define PCINT22 6
+#define PCINT23 7
+#define INT0 0
+#define INT1 1
+#define INT2 2
+#define INT3 3
+#define INT4 4
+#define INT5 5
+#define INT6 6
+#define INT7 7
+
+#endif
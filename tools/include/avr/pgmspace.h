@@ -0,0 +1,25 @@
+/*
+  avr/pgmspace.h - host stand-in for program memory access
+  Part of the Grbl host tools
+*/
+
+#ifndef avr_pgmspace_h
+#define avr_pgmspace_h
+
+#include <stdint.h>
+#include <string.h>
+
+// The host has a single address space, so program memory is ordinary read-only data.
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_byte_near(p) pgm_read_byte(p)
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_float(p) (*(const float *)(p))
+#define strlen_P(s) strlen(s)
+#define strcpy_P(d, s) strcpy((d), (s))
+#define memcpy_P(d, s, n) memcpy((d), (s), (n))
+
+#endif
@@ -0,0 +1,14 @@
+/*
+  avr/sleep.h - host stand-in for sleep control
+  Part of the Grbl host tools
+*/
+
+#ifndef avr_sleep_h
+#define avr_sleep_h
+
+#define SLEEP_MODE_IDLE 0
+#define set_sleep_mode(mode)
+#define sleep_enable()
+#define sleep_cpu()
+
+#endif
@@ -0,0 +1,15 @@
+/*
+  avr/wdt.h - host stand-in for the watchdog timer
+  Part of the Grbl host tools
+*/
+
+#ifndef avr_wdt_h
+#define avr_wdt_h
+
+#define WDTO_15MS 0
+#define WDTO_30MS 1
+#define wdt_reset()
+#define wdt_enable(timeout)
+#define wdt_disable()
+
+#endif
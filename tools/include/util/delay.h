@@ -0,0 +1,13 @@
+/*
+  util/delay.h - host stand-in for busy-wait delays
+  Part of the Grbl host tools
+*/
+
+#ifndef util_delay_h
+#define util_delay_h
+
+// Delays take no time. The estimator accounts for dwells separately.
+#define _delay_ms(ms)
+#define _delay_us(us)
+
+#endif
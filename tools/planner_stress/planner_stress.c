@@ -0,0 +1,411 @@
+/*
+  planner_stress.c - host-side planner throughput harness with synthetic toolpath corpora
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  The harness links the planner, settings and utility modules natively and feeds plan_buffer_line()
+  with generated toolpaths that stress the look-ahead in different ways. Build and run it with
+  'make planner_stress', or run build/planner_stress directly:
+
+    build/planner_stress [-n blocks] [corpus ...]
+
+  -n  Blocks planned per corpus. Default 200000.
+  Without corpus names, all corpora are run.
+
+  The stepper is modeled as keeping up with any feed: whenever the planner buffer is full, the
+  oldest block is discarded before the next one is planned, as the segment generator would after
+  finishing it. So the buffer stays full and every block sees the longest possible look-ahead.
+    For each corpus the harness reports the planning rate on this host, the average and longest
+  planner_recalculate() pass in blocks, how often the optimal plan pointer was moved back towards
+  the tail of the buffer, forcing blocks that were already optimal to be planned again, and the
+  most blocks a single call replanned for an override change. Planner
+  changes should be compared on the same host, since only the relative rates are meaningful.
+    Whenever no override update is pending, the buffered entry speeds are checked against a full
+  replan. Blocks entered slower than it allows, such as slice boundaries left at the old speed
+  after a feed increase, are reported as dips and fail the run.
+  Corpora are generated from a fixed seed, so repeated runs plan identical blocks.
+*/
+
+#include "grbl.h"
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "planner.c"
+
+
+// System globals and firmware entry points the planner and settings modules reference.
+system_t sys;
+int32_t sys_position[N_AXIS];
+uint8_t axis_A_mask, axis_B_mask, axis_C_mask;
+
+void st_update_plan_block_parameters() { }
+void st_generate_step_dir_invert_masks() { }
+void limits_init() { }
+void spindle_init() { }
+void probe_configure_invert_mask(uint8_t is_probe_away) { }
+void protocol_buffer_synchronize() { }
+void protocol_execute_realtime() { }
+void protocol_exec_rt_system() { }
+void report_status_message(uint8_t status_code) { }
+void report_start(uint8_t report) { }
+void print_update_coord_scale() { }
+void system_flag_wco_change() { }
+#if HAS_DIGIPOTS
+  void set_current(uint8_t motor, uint8_t current) { }
+#endif
+
+// EEPROM stand-in. Starts erased, so settings initialize to the compiled defaults.
+static unsigned char stress_eeprom[4096];
+
+unsigned char eeprom_get_char(unsigned int addr) { return(stress_eeprom[addr % sizeof(stress_eeprom)]); }
+void eeprom_put_char(unsigned int addr, unsigned char new_value) { stress_eeprom[addr % sizeof(stress_eeprom)] = new_value; }
+
+void memcpy_to_eeprom_with_checksum(unsigned int destination, char *source, unsigned int size) {
+  for(; size > 0; size--) { eeprom_put_char(destination++, *(source++)); }
+  eeprom_put_char(destination, 0);
+}
+
+int memcpy_from_eeprom_with_checksum(char *destination, unsigned int source, unsigned int size) {
+  for(; size > 0; size--) { *(destination++) = eeprom_get_char(source++); }
+  return(eeprom_get_char(source) == 0);
+}
+
+
+#define STRESS_DEFAULT_BLOCKS 200000
+#define STRESS_OVERRIDE_INTERVAL 4 // Blocks planned between feed override changes in the override storm.
+#define STRESS_STEPUP_INTERVAL 64  // Blocks planned between feed override steps in the step-up corpus.
+
+typedef struct {
+  uint32_t blocks;
+  double seconds;       // Host time spent in the planner.
+  uint32_t passes;      // planner_recalculate() calls that planned at least two blocks.
+  uint64_t pass_blocks;
+  uint8_t pass_max;
+  uint32_t resets;      // Times the optimal plan pointer moved back towards the buffer tail.
+  uint32_t overrides;
+  uint8_t override_max; // Most blocks replanned by a single call after an override change.
+  uint32_t dips;        // Blocks entered slower than a full replan allows, once no update is pending.
+} stress_stats_t;
+static stress_stats_t stats;
+
+static uint32_t stress_tail_sequence; // Blocks discarded since the corpus started.
+static uint32_t stress_random_state;
+static float stress_position[N_AXIS];
+static uint32_t stress_remaining;
+
+
+static double stress_clock()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return(now.tv_sec + 1.0e-9*now.tv_nsec);
+}
+
+
+// Returns a uniformly distributed value in [0,1). xorshift32, for runs that repeat exactly.
+static float stress_random()
+{
+  stress_random_state ^= stress_random_state << 13;
+  stress_random_state ^= stress_random_state >> 17;
+  stress_random_state ^= stress_random_state << 5;
+  return((stress_random_state >> 8)*(1.0/16777216.0));
+}
+
+
+// Position of the optimal plan pointer counted in blocks since the corpus started.
+static uint32_t stress_planned_sequence()
+{
+  uint8_t offset = block_buffer_planned - block_buffer_tail;
+  if (block_buffer_planned < block_buffer_tail) { offset += BLOCK_BUFFER_SIZE; }
+  return(stress_tail_sequence + offset);
+}
+
+
+static void stress_record_pass(uint8_t planned)
+{
+  // Same pass length as the performance counters in planner_recalculate().
+  if (plan_prev_block_index(block_buffer_head) == planned) { return; }
+  uint8_t pass_length = block_buffer_head - planned;
+  if (block_buffer_head < planned) { pass_length += BLOCK_BUFFER_SIZE; }
+  stats.passes++;
+  stats.pass_blocks += pass_length;
+  if (pass_length > stats.pass_max) { stats.pass_max = pass_length; }
+}
+
+
+static void stress_record_override(uint8_t update_index)
+{
+  uint8_t blocks = pl.profile_update_index - update_index;
+  if (pl.profile_update_index < update_index) { blocks += BLOCK_BUFFER_SIZE; }
+  if (blocks > stats.override_max) { stats.override_max = blocks; }
+}
+
+
+// Checks the buffered entry speeds against a full replan from the executing block, as
+// planner_recalculate() would compute from scratch. Run once no override update is pending, so
+// slice boundaries left slower than the plan allows are counted as dips.
+static void stress_check_plan()
+{
+  if (pl.profile_update_pending || (block_buffer_head == block_buffer_tail)) { return; }
+  float entry_speed_sqr[BLOCK_BUFFER_SIZE];
+  uint8_t last_index = plan_prev_block_index(block_buffer_head);
+  plan_block_t *block = &block_buffer[last_index];
+  entry_speed_sqr[last_index] = min(block->max_entry_speed_sqr, 2*block->acceleration*block->millimeters);
+  uint8_t block_index = last_index;
+  while (block_index != block_buffer_tail) {
+    uint8_t next_index = block_index;
+    block_index = plan_prev_block_index(block_index);
+    block = &block_buffer[block_index];
+    entry_speed_sqr[block_index] = min(block->max_entry_speed_sqr,
+      entry_speed_sqr[next_index] + 2*block->acceleration*block->millimeters);
+  }
+  entry_speed_sqr[block_buffer_tail] = block_buffer[block_buffer_tail].entry_speed_sqr;
+  while (block_index != last_index) {
+    block = &block_buffer[block_index];
+    block_index = plan_next_block_index(block_index);
+    entry_speed_sqr[block_index] = min(entry_speed_sqr[block_index],
+      block->entry_speed_sqr + 2*block->acceleration*block->millimeters);
+    if (block_buffer[block_index].entry_speed_sqr < 0.999*entry_speed_sqr[block_index]) { stats.dips++; }
+  }
+}
+
+
+// Plans a move to the current position. Returns false once the corpus has planned enough blocks.
+static uint8_t stress_line(float feed_rate, uint8_t condition)
+{
+  if (stress_remaining == 0) { return(false); }
+
+  // The segment generator replans a slice of an override update whenever it prepares segments.
+  uint8_t update_index = pl.profile_update_index;
+  uint8_t update_pending = pl.profile_update_pending;
+  double start = stress_clock();
+  plan_update_velocity_profile_slice();
+  stats.seconds += stress_clock()-start;
+  if (update_pending) { stress_record_override(update_index); }
+
+  if (plan_check_full_buffer()) {
+    plan_discard_current_block();
+    stress_tail_sequence++;
+  }
+
+  plan_line_data_t pl_data;
+  memset(&pl_data, 0, sizeof(plan_line_data_t));
+  pl_data.feed_rate = feed_rate;
+  pl_data.condition = condition;
+  uint8_t planned = block_buffer_planned;
+  uint32_t planned_sequence = stress_planned_sequence();
+
+  start = stress_clock();
+  uint8_t plan_status = plan_buffer_line(stress_position, &pl_data);
+  stats.seconds += stress_clock()-start;
+
+  if (plan_status == PLAN_OK) {
+    stats.blocks++;
+    stress_remaining--;
+    stress_record_pass(planned);
+  }
+  if (stress_planned_sequence() < planned_sequence) { stats.resets++; }
+  stress_check_plan();
+  return(true);
+}
+
+
+// Applies a feed override change the same way protocol_exec_rt_system() does.
+static void stress_feed_override(uint8_t f_override)
+{
+  if (f_override == sys.f_override) { return; }
+  uint32_t planned_sequence = stress_planned_sequence();
+
+  double start = stress_clock();
+  sys.f_override = f_override;
+  plan_update_velocity_profile_parameters();
+  stats.seconds += stress_clock()-start;
+  stress_record_override(block_buffer_tail);
+
+  stats.overrides++;
+  if (stress_planned_sequence() < planned_sequence) { stats.resets++; }
+}
+
+
+// 3D surfacing. Raster passes of short, irregular segments over a wavy surface. Optionally steps
+// the feed override up by the coarse increment, from the minimum to the maximum and over again,
+// with enough blocks in between for each override update to complete.
+static void stress_surfacing(uint8_t override_steps)
+{
+  uint32_t count = 0;
+  float y = 0.0;
+  for (;;) {
+    float x;
+    for (x = 0.0; x < 100.0; ) {
+      x += 0.05 + 0.2*stress_random();
+      stress_position[AXIS_1] = (((uint32_t)(y/0.5)) & 1) ? 100.0-x : x;
+      stress_position[AXIS_2] = y;
+      stress_position[AXIS_3] = 2.0*sin(stress_position[AXIS_1]/7.0)*cos(y/11.0);
+      if (!stress_line(3000.0, 0)) { return; }
+      if (override_steps && (++count % STRESS_STEPUP_INTERVAL == 0)) {
+        if (sys.f_override >= MAX_FEED_RATE_OVERRIDE) { stress_feed_override(MIN_FEED_RATE_OVERRIDE); }
+        else { stress_feed_override(sys.f_override+FEED_OVERRIDE_COARSE_INCREMENT); }
+      }
+    }
+    y += 0.5;
+  }
+}
+
+static void stress_corpus_surfacing() { stress_surfacing(false); }
+static void stress_corpus_override_stepup() { stress_surfacing(true); }
+
+
+// Zig-zag pocketing. Long passes joined by short stepovers at right angles.
+static void stress_pocketing(uint8_t override_storm)
+{
+  uint32_t count = 0;
+  for (;;) {
+    stress_position[AXIS_1] = (stress_position[AXIS_1] > 0.0) ? 0.0 : 60.0;
+    if (!stress_line(1500.0, 0)) { return; }
+    stress_position[AXIS_2] += 0.5;
+    if (!stress_line(1500.0, 0)) { return; }
+    count += 2;
+    if (override_storm && (count % STRESS_OVERRIDE_INTERVAL == 0)) {
+      stress_feed_override(MIN_FEED_RATE_OVERRIDE +
+        (uint8_t)(stress_random()*(MAX_FEED_RATE_OVERRIDE-MIN_FEED_RATE_OVERRIDE+1)));
+    }
+  }
+}
+
+static void stress_corpus_pocketing() { stress_pocketing(false); }
+static void stress_corpus_override_storm() { stress_pocketing(true); }
+
+
+// Helical descent. Arc chords of 5 degrees on a 5mm radius, 1mm down per turn.
+static void stress_corpus_helix()
+{
+  float angle = 0.0;
+  for (;;) {
+    angle += 5.0*M_PI/180.0;
+    stress_position[AXIS_1] = 5.0*cos(angle);
+    stress_position[AXIS_2] = 5.0*sin(angle);
+    stress_position[AXIS_3] = -angle/(2.0*M_PI);
+    if (!stress_line(1000.0, 0)) { return; }
+  }
+}
+
+
+// Simultaneous 5-axis moves. Short linear moves with large rotary moves in degrees on axes 4 and 5,
+// so the block lengths mix millimeters and degrees.
+static void stress_corpus_rotary()
+{
+  #if N_AXIS > 4
+    float angle = 0.0;
+    for (;;) {
+      angle += 0.01 + 0.02*stress_random();
+      stress_position[AXIS_1] = 20.0*cos(angle);
+      stress_position[AXIS_2] = 20.0*sin(angle);
+      stress_position[AXIS_3] = 0.5*sin(7.0*angle);
+      stress_position[AXIS_4] = 30.0*sin(3.0*angle);
+      stress_position[AXIS_5] = angle*(180.0/M_PI);
+      if (!stress_line(2000.0, 0)) { return; }
+    }
+  #endif
+}
+
+
+typedef struct {
+  const char *name;
+  void (*generate)();
+} stress_corpus_t;
+
+static const stress_corpus_t stress_corpora[] = {
+  { "surfacing", stress_corpus_surfacing },
+  { "pocketing", stress_corpus_pocketing },
+  { "helix", stress_corpus_helix },
+  { "rotary", stress_corpus_rotary },
+  { "override", stress_corpus_override_storm },
+  { "stepup", stress_corpus_override_stepup },
+};
+#define STRESS_CORPUS_COUNT (sizeof(stress_corpora)/sizeof(stress_corpus_t))
+
+
+// Runs a corpus and prints its statistics. Returns false if the plan dipped below a full replan.
+static uint8_t stress_run(const stress_corpus_t *corpus, uint32_t blocks)
+{
+  memset(&stats, 0, sizeof(stats));
+  memset(stress_position, 0, sizeof(stress_position));
+  memset(sys_position, 0, sizeof(sys_position));
+  sys.f_override = DEFAULT_FEED_OVERRIDE;
+  sys.r_override = DEFAULT_RAPID_OVERRIDE;
+  stress_tail_sequence = 0;
+  stress_random_state = 0x2545F491;
+  stress_remaining = blocks;
+  plan_reset();
+  plan_sync_position();
+
+  corpus->generate();
+
+  printf("%-10s %9u %12.0f %9.2f %9u %9u %9u %9u %9u\n", corpus->name, stats.blocks,
+    (stats.seconds > 0.0) ? stats.blocks/stats.seconds : 0.0,
+    stats.passes ? (double)stats.pass_blocks/stats.passes : 0.0, stats.pass_max, stats.resets,
+    stats.overrides, stats.override_max, stats.dips);
+  return(stats.dips == 0);
+}
+
+
+int main(int argc, char *argv[])
+{
+  uint32_t blocks = STRESS_DEFAULT_BLOCKS;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:")) != -1) {
+    switch (opt) {
+      case 'n': blocks = strtoul(optarg, NULL, 10); break;
+      default:
+        fprintf(stderr, "usage: %s [-n blocks] [corpus ...]\n", argv[0]);
+        return(1);
+    }
+  }
+
+  memset(stress_eeprom, 0xff, sizeof(stress_eeprom));
+  settings_init();
+  // Axes 4 and 5 are rotary A and B for the 5-axis corpus: 3200 steps per turn, 30 turns/min,
+  // 10 turns/s^2.
+  #if N_AXIS > 4
+    axis_A_mask = bit(AXIS_4);
+    axis_B_mask = bit(AXIS_5);
+    settings.steps_per_mm[AXIS_4] = settings.steps_per_mm[AXIS_5] = 3200.0/360.0;
+    settings.max_rate[AXIS_4] = settings.max_rate[AXIS_5] = 30.0*360.0;
+    settings.acceleration[AXIS_4] = settings.acceleration[AXIS_5] = 10.0*360.0*60*60;
+  #endif
+
+  printf("Planner buffer: %u blocks. Junction deviation: %.3f mm, %.3f deg.\n\n", BLOCK_BUFFER_SIZE,
+    settings.junction_deviation, settings.rotary_junction_deviation);
+  printf("%-10s %9s %12s %9s %9s %9s %9s %9s %9s\n", "corpus", "blocks", "blocks/s", "avg pass",
+    "max pass", "resets", "overrides", "ovr max", "dips");
+
+  uint8_t idx;
+  uint8_t passed = true;
+  if (optind == argc) {
+    for (idx=0; idx<STRESS_CORPUS_COUNT; idx++) { passed &= stress_run(&stress_corpora[idx], blocks); }
+  } else {
+    for (; optind<argc; optind++) {
+      for (idx=0; idx<STRESS_CORPUS_COUNT; idx++) {
+        if (strcmp(argv[optind], stress_corpora[idx].name) == 0) { break; }
+      }
+      if (idx == STRESS_CORPUS_COUNT) { fprintf(stderr, "unknown corpus: %s\n", argv[optind]); return(1); }
+      passed &= stress_run(&stress_corpora[idx], blocks);
+    }
+  }
+  return(passed ? 0 : 1);
+}
@@ -0,0 +1,505 @@
+/*
+  serial_soak.c - host-side soak test of the serial receive path at high baud rates
+  Part of Grbl
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  The harness compiles the serial module natively and drives its interrupts from a cycle-level model
+  of the USART, the interrupt priorities and a streaming host. Build and run it with
+  'make serial_soak', or run build/serial_soak directly:
+
+    build/serial_soak [-b baud] [-n bytes] [-f step rate] [-r cycles] [-s cycles] [-o cycles]
+                      [-t cycles] [-w usec] [-l cycles] [-h bytes] [-a]
+
+  -b  Baud rate. 8N1 framing, so a byte takes 10 bit times. Default 1000000.
+  -n  Bytes streamed by the host. Default 1000000.
+  -f  Stepper interrupt rate in Hz, or 0 for no motion. Default 30000.
+  -r  Cycles of the receive interrupt, entry to return. Default 110.
+  -s  Cycles of the stepper interrupt up to its sei(), entry included. Default 150.
+  -o  Cycles of the step pulse reset (Timer0 overflow) interrupt. Default 90.
+  -t  Cycles of the transmit (data register empty) interrupt. Default 70.
+  -w  Step pulse length in microseconds, after which the Timer0 overflow fires. Default 10.
+  -l  Cycles the main program spends on each line, or 0 to drain the buffer at once. Default 0,
+      or 8000 with serial flow control, so the host outruns the parser and must be held off.
+  -h  Bytes the host still sends after it receives XOFF. Default 16.
+  -a  Allow overruns. Reports lost bytes without failing, to find where the receive timing stops
+      holding up, such as at 2000000 baud.
+
+  First, every byte value is received on its own and the outcome is checked against a reference
+  decoder of the realtime commands, written out as the switch statement the lookup table replaced.
+  Then the host streams a g-code job with interleaved status report requests back to back at the
+  baud rate, while the stepper interrupt fires at the step rate. Only the part of the stepper
+  interrupt before its sei() holds off the receive interrupt. The model keeps the two byte receive
+  FIFO of the USART, loses bytes exactly as its data overrun does, and requires the overrun counter
+  to match. Every byte that survives must reach the main program in order, and every surviving
+  status request must set its flag. With ENABLE_XONXOFF, the host also obeys the XOFF and XON
+  characters sent by the transmit interrupt, keeps polling the status while stopped, and the
+  receive buffer must never overflow.
+    The default interrupt cycle counts are estimates for an ATmega2560 at 16MHz with all axes
+  stepping, not measured on a build. Count them for a real build in the 'make disasm' listing, or
+  time them with 'make bench', and pass them in. Results with the defaults are estimates as well.
+  The harness exits with an error on any mismatch, and on any overrun unless allowed.
+*/
+
+#include "grbl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "serial.c"
+
+
+// Register file stand-in. See avr/io.h.
+#define AVR_DEFINE_8(r) volatile uint8_t r;
+#define AVR_DEFINE_16(r) volatile uint16_t r;
+AVR_REGISTERS_8(AVR_DEFINE_8)
+AVR_REGISTERS_16(AVR_DEFINE_16)
+
+// System globals and firmware entry points the serial module references.
+system_t sys;
+volatile uint8_t sys_rt_exec_state;
+volatile uint8_t sys_rt_exec_motion_override;
+volatile uint8_t sys_rt_exec_accessory_override;
+#ifdef DEBUG
+  volatile uint8_t sys_rt_exec_debug;
+#endif
+#ifdef ENABLE_PERFORMANCE_COUNTERS
+  volatile perf_t perf;
+#endif
+
+static uint32_t soak_status_requests; // Status report requests decoded by the receive interrupt.
+static uint32_t soak_resets;
+
+void system_set_exec_state_flag(uint8_t mask)
+{
+  sys_rt_exec_state |= mask;
+  if (mask & EXEC_STATUS_REPORT) { soak_status_requests++; }
+}
+void system_set_exec_motion_override_flag(uint8_t mask) { sys_rt_exec_motion_override |= mask; }
+void system_set_exec_accessory_override_flag(uint8_t mask) { sys_rt_exec_accessory_override |= mask; }
+void mc_reset() { soak_resets++; }
+
+
+#define SOAK_DEFAULT_BAUD 1000000
+#define SOAK_DEFAULT_BYTES 1000000
+#define SOAK_STATUS_INTERVAL 97  // Stream bytes between status report requests of the host.
+#define SOAK_STOPPED_POLL 1000   // Byte times between status report requests while stopped.
+
+typedef struct {
+  uint32_t baud;
+  uint32_t bytes;
+  uint32_t step_rate;
+  uint16_t rx_cycles;
+  uint16_t step_cycles;
+  uint16_t pulse_reset_cycles;
+  uint16_t tx_cycles;
+  uint16_t pulse_us;
+  uint32_t line_cycles;
+  uint16_t host_latency;
+  uint8_t allow_overruns;
+} soak_config_t;
+static soak_config_t config = {
+  SOAK_DEFAULT_BAUD, SOAK_DEFAULT_BYTES, 30000, 110, 150, 90, 70, 10,
+  #ifdef SERIAL_FLOW_CONTROL
+    8000,
+  #else
+    0,
+  #endif
+  16, false
+};
+
+static uint8_t soak_failed;
+
+static void soak_fail(const char *message, int value)
+{
+  printf("FAIL: %s (%d)\n", message, value);
+  soak_failed = true;
+}
+
+
+// Outcome of receiving a single byte.
+typedef struct {
+  uint8_t state;
+  uint8_t motion;
+  uint8_t accessory;
+  uint8_t reset;
+  int16_t stored; // Byte stored for the main program, or -1.
+} soak_outcome_t;
+
+
+// Reference decoder. The realtime command switch of ISR(SERIAL_RX) before the lookup table.
+static soak_outcome_t soak_reference(uint8_t data)
+{
+  soak_outcome_t out = { 0, 0, 0, 0, -1 };
+  switch (data) {
+    case CMD_RESET:         out.reset = true; break;
+    case CMD_STATUS_REPORT: out.state = EXEC_STATUS_REPORT; break;
+    case CMD_CYCLE_START:   out.state = EXEC_CYCLE_START; break;
+    case CMD_FEED_HOLD:     out.state = EXEC_FEED_HOLD; break;
+    default :
+      if (data > 0x7F) {
+        switch(data) {
+          case CMD_SAFETY_DOOR:   out.state = EXEC_SAFETY_DOOR; break;
+          case CMD_JOG_CANCEL:    out.state = EXEC_MOTION_CANCEL; break; // Jogging in this test.
+          case CMD_FEED_OVR_RESET: out.motion = EXEC_FEED_OVR_RESET; break;
+          case CMD_FEED_OVR_COARSE_PLUS: out.motion = EXEC_FEED_OVR_COARSE_PLUS; break;
+          case CMD_FEED_OVR_COARSE_MINUS: out.motion = EXEC_FEED_OVR_COARSE_MINUS; break;
+          case CMD_FEED_OVR_FINE_PLUS: out.motion = EXEC_FEED_OVR_FINE_PLUS; break;
+          case CMD_FEED_OVR_FINE_MINUS: out.motion = EXEC_FEED_OVR_FINE_MINUS; break;
+          case CMD_RAPID_OVR_RESET: out.motion = EXEC_RAPID_OVR_RESET; break;
+          case CMD_RAPID_OVR_MEDIUM: out.motion = EXEC_RAPID_OVR_MEDIUM; break;
+          case CMD_RAPID_OVR_LOW: out.motion = EXEC_RAPID_OVR_LOW; break;
+          case CMD_SPINDLE_OVR_RESET: out.accessory = EXEC_SPINDLE_OVR_RESET; break;
+          case CMD_SPINDLE_OVR_COARSE_PLUS: out.accessory = EXEC_SPINDLE_OVR_COARSE_PLUS; break;
+          case CMD_SPINDLE_OVR_COARSE_MINUS: out.accessory = EXEC_SPINDLE_OVR_COARSE_MINUS; break;
+          case CMD_SPINDLE_OVR_FINE_PLUS: out.accessory = EXEC_SPINDLE_OVR_FINE_PLUS; break;
+          case CMD_SPINDLE_OVR_FINE_MINUS: out.accessory = EXEC_SPINDLE_OVR_FINE_MINUS; break;
+          case CMD_SPINDLE_OVR_STOP: out.accessory = EXEC_SPINDLE_OVR_STOP; break;
+          case CMD_COOLANT_FLOOD_OVR_TOGGLE: out.accessory = EXEC_COOLANT_FLOOD_OVR_TOGGLE; break;
+          case CMD_COOLANT_MIST_OVR_TOGGLE: out.accessory = EXEC_COOLANT_MIST_OVR_TOGGLE; break;
+        }
+      } else {
+        out.stored = data;
+        #ifdef ENABLE_RX_LINE_ASSEMBLY
+          // Line filter of the protocol module. The byte is followed by a newline in this test.
+          if ((data <= ' ') || (data == '/') || (data == '(') || (data == ';')) { out.stored = -1; }
+          else if ((data >= 'a') && (data <= 'z')) { out.stored = data-'a'+'A'; }
+        #endif
+      }
+  }
+  return(out);
+}
+
+
+static void soak_receive(uint8_t data, uint8_t status)
+{
+  UCSR0A = status;
+  UDR0 = data;
+  SERIAL_RX();
+}
+
+
+static void soak_check_classification()
+{
+  uint16_t data;
+  uint16_t mismatches = 0;
+  for (data=0; data<256; data++) {
+    serial_reset_read_buffer();
+    sys_rt_exec_state = sys_rt_exec_motion_override = sys_rt_exec_accessory_override = 0;
+    soak_resets = 0;
+    sys.state = STATE_JOG;
+    soak_receive(data, 0);
+
+    soak_outcome_t out = { sys_rt_exec_state, sys_rt_exec_motion_override, sys_rt_exec_accessory_override,
+                           (soak_resets != 0), -1 };
+    #ifdef ENABLE_RX_LINE_ASSEMBLY
+      soak_receive('\n', 0);
+      char line[LINE_BUFFER_SIZE];
+      char *stored = serial_get_line(line);
+      if (stored == NULL) {
+        out.stored = -2; // Line lost.
+      } else {
+        if (stored[0] != 0) { out.stored = (uint8_t)stored[0]; }
+        serial_release_line();
+      }
+    #else
+      if (serial_get_rx_buffer_count()) { out.stored = serial_read(); }
+    #endif
+
+    soak_outcome_t ref = soak_reference(data);
+    if (memcmp(&out, &ref, sizeof(out)) != 0) {
+      printf("byte 0x%02X: state %02X motion %02X accessory %02X reset %u stored %d, expected %02X %02X %02X %u %d\n",
+        data, out.state, out.motion, out.accessory, out.reset, out.stored, ref.state, ref.motion,
+        ref.accessory, ref.reset, ref.stored);
+      mismatches++;
+    }
+  }
+  if (mismatches) { soak_fail("receive classification mismatches", mismatches); }
+  else { printf("Classification: all 256 byte values decoded as the reference switch.\n"); }
+}
+
+
+// Job streamed by the host. Upper case without spaces, so the line filter leaves it unchanged.
+static uint8_t *soak_stream;
+static uint32_t soak_stream_length;
+
+static void soak_generate_stream(uint32_t length)
+{
+  uint32_t random_state = 0x2545F491;
+  uint32_t until_status = SOAK_STATUS_INTERVAL;
+  char line[48];
+  soak_stream = malloc(length);
+  soak_stream_length = 0;
+  while (soak_stream_length < length) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    int n = sprintf(line, "G1X%d.%03dY-%d.%03dF%d\n", (random_state >> 4) % 300, (random_state >> 12) % 1000,
+      (random_state >> 20) % 200, random_state % 1000, 500 + ((random_state >> 8) % 2000));
+    int idx;
+    for (idx=0; (idx<n) && (soak_stream_length<length); idx++) {
+      if (--until_status == 0) {
+        soak_stream[soak_stream_length++] = CMD_STATUS_REPORT;
+        until_status = SOAK_STATUS_INTERVAL;
+        if (soak_stream_length == length) { break; }
+      }
+      soak_stream[soak_stream_length++] = line[idx];
+    }
+  }
+  soak_stream[length-1] = '\n';
+}
+
+
+// USART receive FIFO. A data overrun loses every byte arriving while the FIFO is full. Its DOR
+// flag is buffered with the newest byte and read along with it.
+static uint8_t fifo_data[2];
+static uint8_t fifo_dor[2];
+static uint64_t fifo_arrival[2];
+static uint8_t fifo_count;
+
+typedef struct {
+  uint32_t sent;
+  uint32_t lost;
+  uint32_t overruns;      // Overrun events, i.e. reads with the DOR flag set.
+  uint32_t status_sent;   // Status report requests not lost.
+  uint32_t latency_max;   // Longest wait of a byte in the FIFO, in cycles.
+  uint32_t xoff, xon;
+  uint8_t rx_count_max;   // Fullest receive ring buffer seen by the main program.
+} soak_stats_t;
+static soak_stats_t stats;
+
+// Bytes the main program must receive, and the bytes it did.
+static uint8_t *soak_expected;
+static uint32_t soak_expected_length;
+static uint8_t *soak_delivered;
+static uint32_t soak_delivered_length;
+
+
+static void soak_uart_arrival(uint8_t data, uint64_t cycle)
+{
+  stats.sent++;
+  if (fifo_count == 2) {
+    stats.lost++;
+    fifo_dor[1] = true;
+    return;
+  }
+  fifo_data[fifo_count] = data;
+  fifo_dor[fifo_count] = false;
+  fifo_arrival[fifo_count] = cycle;
+  fifo_count++;
+  if (data == CMD_STATUS_REPORT) { stats.status_sent++; }
+  else { soak_expected[soak_expected_length++] = data; }
+}
+
+
+// Main program. Takes one line, or everything, from the receive buffer.
+static void soak_main_program(uint8_t all)
+{
+  uint8_t count = serial_get_rx_buffer_count();
+  if (count > stats.rx_count_max) { stats.rx_count_max = count; }
+  do {
+    #ifdef ENABLE_RX_LINE_ASSEMBLY
+      char line[LINE_BUFFER_SIZE];
+      char *stored = serial_get_line(line);
+      if (stored == NULL) { return; }
+      uint8_t length = strlen(stored);
+      memcpy(&soak_delivered[soak_delivered_length], stored, length);
+      soak_delivered_length += length;
+      soak_delivered[soak_delivered_length++] = '\n';
+      serial_release_line();
+    #else
+      uint8_t data;
+      do {
+        data = serial_read();
+        if (data == SERIAL_NO_DATA) { return; }
+        soak_delivered[soak_delivered_length++] = data;
+      } while (data != '\n');
+    #endif
+  } while (all);
+}
+
+
+static void soak_stream_job()
+{
+  const uint64_t byte_cycles = (uint64_t)F_CPU*10/config.baud;
+  const uint64_t step_cycles = config.step_rate ? F_CPU/config.step_rate : 0;
+  const uint64_t pulse_cycles = (uint64_t)config.pulse_us*(F_CPU/1000000);
+
+  serial_reset_read_buffer();
+  memset(&stats, 0, sizeof(stats));
+  fifo_count = 0;
+  soak_expected = malloc(soak_stream_length);
+  soak_delivered = malloc(soak_stream_length+LINE_BUFFER_SIZE);
+  soak_expected_length = soak_delivered_length = 0;
+  soak_status_requests = 0;
+  sys.state = STATE_CYCLE;
+
+  uint64_t cycle = 0;
+  uint64_t busy_until = 0;        // End of the interrupt running with interrupts disabled.
+  uint64_t host_next = 0;         // Start of the next byte time of the host.
+  uint32_t host_index = 0;
+  uint8_t host_stopped = false;
+  uint16_t host_countdown = 0;    // Bytes the host still sends after XOFF.
+  uint32_t host_poll = 0;
+  uint64_t step_next = step_cycles;
+  uint8_t step_pending = false;
+  uint64_t pulse_reset_at = 0;
+  uint8_t pulse_reset_pending = false;
+  uint64_t tx_free = 0;           // End of the byte being transmitted.
+  int16_t tx_data = -1;
+  uint64_t main_next = 0;
+
+  while ((host_index < soak_stream_length) || fifo_count || (busy_until > cycle)) {
+    // Host. Sends one byte per byte time, unless held off by XOFF.
+    if (cycle == host_next) {
+      host_next += byte_cycles;
+      if (host_index < soak_stream_length) {
+        if (!host_stopped) {
+          soak_uart_arrival(soak_stream[host_index++], cycle);
+          if (host_countdown && (--host_countdown == 0)) { host_stopped = true; }
+        } else if (++host_poll == SOAK_STOPPED_POLL) {
+          host_poll = 0;
+          soak_uart_arrival(CMD_STATUS_REPORT, cycle);
+        }
+      }
+    }
+    // Transmit shift register. The host acts on a flow control character once it is sent.
+    if ((tx_data >= 0) && (cycle == tx_free)) {
+      #ifdef ENABLE_XONXOFF
+        if (tx_data == XOFF_CHAR) {
+          stats.xoff++;
+          host_countdown = config.host_latency;
+          if (host_countdown == 0) { host_stopped = true; }
+        } else if (tx_data == XON_CHAR) {
+          stats.xon++;
+          host_stopped = false;
+          host_countdown = 0;
+        }
+      #endif
+      tx_data = -1;
+    }
+    if (step_cycles && (cycle == step_next)) {
+      step_next += step_cycles;
+      step_pending = true;
+    }
+    if (pulse_reset_at && (cycle == pulse_reset_at)) {
+      pulse_reset_at = 0;
+      pulse_reset_pending = true;
+    }
+
+    // Interrupts, by vector priority, run only with interrupts enabled. Otherwise the main program.
+    if (cycle >= busy_until) {
+      if (step_pending) {
+        step_pending = false;
+        busy_until = cycle+config.step_cycles;
+        pulse_reset_at = busy_until+pulse_cycles;
+      } else if (pulse_reset_pending) {
+        pulse_reset_pending = false;
+        busy_until = cycle+config.pulse_reset_cycles;
+      } else if (fifo_count) {
+        uint32_t latency = cycle-fifo_arrival[0];
+        if (latency > stats.latency_max) { stats.latency_max = latency; }
+        if (fifo_dor[0]) { stats.overruns++; }
+        soak_receive(fifo_data[0], fifo_dor[0] ? (1 << DOR0) : 0);
+        fifo_data[0] = fifo_data[1];
+        fifo_dor[0] = fifo_dor[1];
+        fifo_arrival[0] = fifo_arrival[1];
+        fifo_count--;
+        busy_until = cycle+config.rx_cycles;
+      } else if ((UCSR0B & (1 << UDRIE0)) && (cycle >= tx_free)) {
+        UDR0 = 0;
+        SERIAL_UDRE();
+        tx_data = UDR0;
+        tx_free = cycle+byte_cycles;
+        busy_until = cycle+config.tx_cycles;
+      } else if (cycle >= main_next) {
+        soak_main_program(config.line_cycles == 0);
+        main_next = cycle+config.line_cycles;
+      }
+    }
+    cycle++;
+  }
+  soak_main_program(true);
+
+  printf("%8u baud: %3u cycles/byte, %8u bytes sent, %6u lost in %6u overruns, max FIFO wait %4u cycles",
+    config.baud, (uint32_t)byte_cycles, stats.sent, stats.lost, stats.overruns, stats.latency_max);
+  #ifdef SERIAL_FLOW_CONTROL
+    printf(", %u XOFF, %u XON, max RX buffer %u/%u", stats.xoff, stats.xon, stats.rx_count_max, RX_BUFFER_SIZE);
+  #endif
+  printf(".\n");
+
+  if (stats.overruns && !config.allow_overruns) { soak_fail("bytes lost to overruns", stats.lost); }
+  if (serial_get_rx_overrun_count() != (uint16_t)stats.overruns) { // The counter wraps at 16 bits.
+    soak_fail("overrun counter differs from the USART model", serial_get_rx_overrun_count()-(uint16_t)stats.overruns);
+  }
+  if (soak_status_requests != stats.status_sent) {
+    soak_fail("status requests lost or duplicated", (int)soak_status_requests-(int)stats.status_sent);
+  }
+  // Once bytes are lost, the interrupts use up all of the time and the main program falls behind,
+  // so the receive buffer also overflows. The stream is only checked without overruns.
+  if (stats.lost == 0) {
+    if ((soak_delivered_length != soak_expected_length) ||
+        memcmp(soak_delivered, soak_expected, soak_expected_length)) {
+      soak_fail("received stream differs from the bytes sent", (int)soak_delivered_length-(int)soak_expected_length);
+    }
+    #ifdef ENABLE_XONXOFF
+      // The host may still be stopped by the last XOFF when its job ends.
+      if ((stats.rx_count_max >= RX_BUFFER_FLOW_HIGH) && (stats.xoff == 0)) { soak_fail("no XOFF at the high watermark", stats.rx_count_max); }
+      if ((stats.xoff-stats.xon) > 1) { soak_fail("XOFF not followed by XON", stats.xoff-stats.xon); }
+    #endif
+  }
+  free(soak_expected);
+  free(soak_delivered);
+}
+
+
+int main(int argc, char *argv[])
+{
+  int opt;
+  uint8_t timings = 0; // Interrupt timings passed in, instead of the estimated defaults.
+  while ((opt = getopt(argc, argv, "b:n:f:r:s:o:t:w:l:h:a")) != -1) {
+    switch (opt) {
+      case 'b': config.baud = strtoul(optarg, NULL, 10); break;
+      case 'n': config.bytes = strtoul(optarg, NULL, 10); break;
+      case 'f': config.step_rate = strtoul(optarg, NULL, 10); break;
+      case 'r': config.rx_cycles = strtoul(optarg, NULL, 10); timings |= bit(0); break;
+      case 's': config.step_cycles = strtoul(optarg, NULL, 10); timings |= bit(1); break;
+      case 'o': config.pulse_reset_cycles = strtoul(optarg, NULL, 10); timings |= bit(2); break;
+      case 't': config.tx_cycles = strtoul(optarg, NULL, 10); timings |= bit(3); break;
+      case 'w': config.pulse_us = strtoul(optarg, NULL, 10); break;
+      case 'l': config.line_cycles = strtoul(optarg, NULL, 10); break;
+      case 'h': config.host_latency = strtoul(optarg, NULL, 10); break;
+      case 'a': config.allow_overruns = true; break;
+      default:
+        fprintf(stderr, "usage: %s [-b baud] [-n bytes] [-f step rate] [-r cycles] [-s cycles] [-o cycles]"
+          " [-t cycles] [-w usec] [-l cycles] [-h bytes] [-a]\n", argv[0]);
+        return(1);
+    }
+  }
+  if ((config.baud == 0) || (config.baud > F_CPU/8) || (config.bytes == 0)) {
+    fprintf(stderr, "baud rate must be 1 to %lu and bytes at least 1\n", (unsigned long)(F_CPU/8));
+    return(1);
+  }
+
+  soak_check_classification();
+  soak_generate_stream(config.bytes);
+  printf("Receive interrupt %u cycles, stepper %u cycles before sei() at %u Hz, pulse reset %u cycles%s.\n",
+    config.rx_cycles, config.step_cycles, config.step_rate, config.pulse_reset_cycles,
+    (timings == 0x0f) ? "" : " (estimated timings)");
+  soak_stream_job();
+  free(soak_stream);
+  return(soak_failed ? 1 : 0);
+}